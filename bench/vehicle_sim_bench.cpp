@@ -0,0 +1,524 @@
+// Microbenchmarks for the simulation hot paths.
+//
+// Usage: vehicle_sim_bench [--json] [filter]
+// Runs every benchmark whose name contains the filter (all by default) and
+// prints the time and heap allocations per operation, as a table or, with
+// --json, as one JSON document for comparing runs across commits. Inputs
+// come from a fixed seed so runs are comparable.
+
+#include "BinaryPublisher.h"
+#include "DeltaCodec.h"
+#include "KafkaFrame.h"
+#include "KafkaPublisher.h"
+#include "MockKafkaBackend.h"
+#include "Route.h"
+#include "TelemetryReader.h"
+#include "Vehicle.h"
+#include "VehicleSerializer.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <new>
+#include <random>
+#include <string>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+using json = nlohmann::json;
+
+// Heap allocations made by any thread since startup, counted by the
+// replacement operator new below
+static std::atomic<std::uint64_t> allocationCount{0};
+
+void* operator new(std::size_t size) {
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    if (void* memory = std::malloc(size == 0 ? 1 : size)) {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+// Inlined into callers, these free() memory that GCC only knows came from
+// operator new, not that the new above got it from malloc(); the pairing is
+// correct, so -Wmismatched-new-delete is silenced for them alone
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+void operator delete(void* memory) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void* memory, std::size_t) noexcept {
+    std::free(memory);
+}
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+namespace {
+
+// Fixed seed for all generated inputs
+constexpr std::uint32_t BenchSeed = 42;
+
+// Keeps the optimizer from discarding benchmark results
+volatile std::size_t benchSink;
+
+// One benchmark: runs its operation `iterations` times per call
+struct Benchmark {
+    std::string name;
+    std::function<void(std::size_t iterations)> run;
+};
+
+// Measurements of the final run of a benchmark
+struct BenchResult {
+    std::size_t iterations = 0;
+    double nanosPerOp = 0.0;
+    double allocationsPerOp = 0.0; // Includes allocations of threads the benchmark starts
+};
+
+// Time a benchmark, growing the iteration count until a run takes long enough
+BenchResult measure(const Benchmark& benchmark) {
+    using Clock = std::chrono::steady_clock;
+    const double minSeconds = 0.5;
+
+    benchmark.run(1); // Warm up
+
+    std::size_t iterations = 1;
+    for (;;) {
+        std::uint64_t allocations = allocationCount.load(std::memory_order_relaxed);
+        auto start = Clock::now();
+        benchmark.run(iterations);
+        double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        if (seconds >= minSeconds || iterations >= (std::size_t(1) << 34)) {
+            allocations = allocationCount.load(std::memory_order_relaxed) - allocations;
+            return {iterations, seconds * 1e9 / static_cast<double>(iterations),
+                    static_cast<double>(allocations) / static_cast<double>(iterations)};
+        }
+        double scale = seconds > 0.0 ? minSeconds * 1.2 / seconds : 100.0;
+        iterations = static_cast<std::size_t>(static_cast<double>(iterations) * std::min(100.0, std::max(2.0, scale)));
+    }
+}
+
+// Random vehicle states around San Francisco with ids that own their storage
+struct StateSet {
+    std::vector<std::string> ids;
+    std::vector<VehicleState> states;
+
+    explicit StateSet(std::size_t count) {
+        std::mt19937 rng(BenchSeed);
+        std::uniform_real_distribution<double> offset(-0.05, 0.05);
+        std::uniform_real_distribution<double> heading(0.0, 6.283185307179586);
+        std::uniform_real_distribution<double> speed(0.0, 25.0);
+
+        ids.reserve(count);
+        for (std::size_t i = 0; i < count; ++i) {
+            ids.push_back("vehicle" + std::to_string(i));
+        }
+        for (std::size_t i = 0; i < count; ++i) {
+            states.push_back({static_cast<VehicleHandle>(i), ids[i],
+                              {37.7749 + offset(rng), -122.4194 + offset(rng)},
+                              heading(rng), speed(rng)});
+        }
+    }
+};
+
+// DOM serialization, as the publishers did before the direct serializer
+std::string vehicleToJsonDom(const VehicleState& state, std::time_t timestamp) {
+    json j;
+    j["id"] = state.id;
+    j["timestamp"] = timestamp;
+    j["position"] = {
+            {"lat", state.position.lat},
+            {"lon", state.position.lon}
+    };
+    j["heading"] = state.heading;
+    j["speed"] = state.speed;
+    return j.dump();
+}
+
+// DOM serialization of the console's pretty-printed update, as main did
+// before the console sink
+std::string vehicleToJsonDomIndented(const VehicleState& state) {
+    json j;
+    j["id"] = state.id;
+    j["position"] = {
+            {"lat", state.position.lat},
+            {"lon", state.position.lon}
+    };
+    j["heading"] = state.heading;
+    j["speed"] = state.speed;
+    return j.dump(2);
+}
+
+// Serializer benchmarks over a shared set of states
+std::vector<Benchmark> serializerBenchmarks() {
+    auto states = std::make_shared<StateSet>(1024);
+    const std::time_t timestamp = 1700000000;
+
+    // Both paths must produce the same bytes, or the comparison is meaningless
+    {
+        VehicleJsonSerializer serializer;
+        std::string direct;
+        for (const VehicleState& state : states->states) {
+            direct.clear();
+            serializer.append(direct, state, timestamp);
+            if (direct != vehicleToJsonDom(state, timestamp)) {
+                std::fprintf(stderr, "Serializer output differs from nlohmann for %s\n",
+                             std::string(state.id).c_str());
+            }
+            direct.clear();
+            serializer.appendIndented(direct, state);
+            if (direct != vehicleToJsonDomIndented(state)) {
+                std::fprintf(stderr, "Indented serializer output differs from nlohmann for %s\n",
+                             std::string(state.id).c_str());
+            }
+        }
+    }
+
+    // Binary telemetry must read back as written, up to its fixed-point and float precision
+    {
+        std::string path = (std::filesystem::temp_directory_path() / "vehicle_sim_bench.bin").string();
+        const std::uint64_t ticks = 3;
+        {
+            BinaryPublisher publisher(path, 0.1);
+            std::vector<VehicleRecord> records;
+            for (std::uint64_t tick = 0; tick < ticks; ++tick) {
+                records.clear();
+                for (const VehicleState& state : states->states) {
+                    records.push_back({state, tick, timestamp});
+                }
+                TickInfo info{tick, 0.1 * static_cast<double>(tick), 0.1, timestamp};
+                publisher.publish({info, records.data(), records.size(), std::string_view(), nullptr});
+            }
+            publisher.close();
+        }
+
+        TelemetryReader reader(path);
+        if (!reader.isComplete() || reader.size() != ticks * states->states.size()) {
+            std::fprintf(stderr, "Binary telemetry read back %zu records, expected %zu\n",
+                         reader.size(), static_cast<std::size_t>(ticks * states->states.size()));
+        } else {
+            for (std::size_t i = 0; i < reader.size(); ++i) {
+                TelemetryRecord record = reader[i];
+                const VehicleState& state = states->states[i % states->states.size()];
+                if (reader.idOf(record.vehicleIndex) != state.id || record.tick != i / states->states.size()
+                    || record.lat != encodeCoordinate(state.position.lat) / TelemetryCoordinateScale
+                    || record.lon != encodeCoordinate(state.position.lon) / TelemetryCoordinateScale
+                    || record.heading != static_cast<float>(state.heading)
+                    || record.speed != static_cast<float>(state.speed)) {
+                    std::fprintf(stderr, "Binary telemetry record %zu differs from %s\n", i,
+                                 std::string(state.id).c_str());
+                    break;
+                }
+            }
+        }
+        std::remove(path.c_str());
+    }
+
+    std::vector<Benchmark> benchmarks;
+    benchmarks.push_back({"vehicleToJson/dom", [states, timestamp](std::size_t iterations) {
+        std::size_t bytes = 0;
+        for (std::size_t i = 0; i < iterations; ++i) {
+            bytes += vehicleToJsonDom(states->states[i & 1023], timestamp).size();
+        }
+        benchSink = bytes;
+    }});
+    benchmarks.push_back({"vehicleToJson/direct", [states, timestamp](std::size_t iterations) {
+        VehicleJsonSerializer serializer;
+        std::string buffer;
+        buffer.reserve(4096);
+        std::size_t bytes = 0;
+        for (std::size_t i = 0; i < iterations; ++i) {
+            buffer.clear();
+            serializer.append(buffer, states->states[i & 1023], timestamp);
+            bytes += buffer.size();
+        }
+        benchSink = bytes;
+    }});
+    benchmarks.push_back({"vehicleToJson/dom-indented", [states](std::size_t iterations) {
+        std::size_t bytes = 0;
+        for (std::size_t i = 0; i < iterations; ++i) {
+            bytes += vehicleToJsonDomIndented(states->states[i & 1023]).size();
+        }
+        benchSink = bytes;
+    }});
+    benchmarks.push_back({"vehicleToJson/indented", [states](std::size_t iterations) {
+        VehicleJsonSerializer serializer;
+        std::string buffer;
+        buffer.reserve(4096);
+        std::size_t bytes = 0;
+        for (std::size_t i = 0; i < iterations; ++i) {
+            buffer.clear();
+            serializer.appendIndented(buffer, states->states[i & 1023]);
+            bytes += buffer.size();
+        }
+        benchSink = bytes;
+    }});
+    return benchmarks;
+}
+
+// Random walk of waypoints around San Francisco, 100 to 300 m apart
+std::vector<GeoPoint> randomWaypoints(std::mt19937& rng, std::size_t count) {
+    std::uniform_real_distribution<double> heading(0.0, 6.283185307179586);
+    std::uniform_real_distribution<double> step(100.0, 300.0);
+    const double metresPerDegree = 111320.0;
+
+    std::vector<GeoPoint> waypoints;
+    GeoPoint point{37.7749, -122.4194};
+    for (std::size_t i = 0; i < count; ++i) {
+        waypoints.push_back(point);
+        double direction = heading(rng);
+        double distance = step(rng);
+        point.lat += distance * std::cos(direction) / metresPerDegree;
+        point.lon += distance * std::sin(direction) / (metresPerDegree * std::cos(point.lat * M_PI / 180.0));
+    }
+    return waypoints;
+}
+
+// Geometry and route stepping benchmarks
+std::vector<Benchmark> simulationBenchmarks() {
+    std::vector<Benchmark> benchmarks;
+
+    // Haversine between random pairs of points
+    auto points = std::make_shared<StateSet>(1025);
+    benchmarks.push_back({"geoPoint/distanceTo", [points](std::size_t iterations) {
+        const std::vector<VehicleState>& states = points->states;
+        double total = 0.0;
+        for (std::size_t i = 0; i < iterations; ++i) {
+            total += states[i & 1023].position.distanceTo(states[(i & 1023) + 1].position);
+        }
+        benchSink = static_cast<std::size_t>(total);
+    }});
+
+    // One vehicle of a 1024-vehicle fleet per operation, round robin. The
+    // fleet keeps its state across runs, so the shared route is long enough
+    // (about 2000 km) that no vehicle finishes it and parks while measured.
+    auto fleet = std::make_shared<FleetStore>();
+    auto vehicles = std::make_shared<std::vector<Vehicle>>();
+    {
+        std::mt19937 rng(BenchSeed);
+        auto geometry = std::make_shared<const RouteGeometry>(randomWaypoints(rng, 10000));
+        std::uniform_int_distribution<std::uint32_t> start(0, 999);
+        for (std::size_t i = 0; i < 1024; ++i) {
+            RouteCursor cursor;
+            cursor.waypointIndex = start(rng);
+            Route route(geometry, cursor);
+            VehicleHandle handle = fleet->add("vehicle" + std::to_string(i), route.getCurrentWaypoint(), route);
+            vehicles->emplace_back(fleet.get(), handle);
+        }
+    }
+    benchmarks.push_back({"vehicle/update", [fleet, vehicles](std::size_t iterations) {
+        for (std::size_t i = 0; i < iterations; ++i) {
+            (*vehicles)[i & 1023].update(0.1);
+        }
+        benchSink = static_cast<std::size_t>((*vehicles)[0].getSpeed());
+    }});
+
+    // Cursor stepping over a 64-waypoint route, restarting finished routes
+    std::mt19937 rng(BenchSeed);
+    auto geometry = std::make_shared<const RouteGeometry>(randomWaypoints(rng, 64));
+    benchmarks.push_back({"route/advanceToNextWaypoint", [geometry](std::size_t iterations) {
+        std::vector<Route> routes(1024, Route(geometry, RouteCursor()));
+        std::size_t advanced = 0;
+        for (std::size_t i = 0; i < iterations; ++i) {
+            Route& route = routes[i & 1023];
+            if (route.advanceToNextWaypoint()) {
+                ++advanced;
+            } else {
+                route = Route(geometry, RouteCursor());
+            }
+        }
+        benchSink = advanced;
+    }});
+    return benchmarks;
+}
+
+// Kafka publishing through the in-process broker: per-update cost of the
+// dispatcher's shared JSON or the publisher's delta encoding, the payload
+// pool, produce and delivery reports
+std::vector<Benchmark> kafkaBenchmarks() {
+    auto states = std::make_shared<StateSet>(1024);
+    auto records = std::make_shared<std::vector<VehicleRecord>>();
+    for (const VehicleState& state : states->states) {
+        records->push_back({state, 0, 1700000000});
+    }
+
+    // Delta frames must decode to the quantized states they were built from,
+    // across keyframes, deltas and headings wrapping past 2pi
+    {
+        DeltaEncoder encoder(4);
+        DeltaDecoder decoder;
+        std::vector<VehicleState> moving = states->states;
+        std::string frame;
+        std::vector<std::uint32_t> recordEnds;
+        bool matched = true;
+        for (std::uint64_t tick = 0; tick < 10 && matched; ++tick) {
+            const std::time_t timestamp = 1700000000 + static_cast<std::time_t>(tick);
+            frame.clear();
+            recordEnds.clear();
+            beginKafkaFrame(frame, KafkaEncoding::Delta, tick);
+            for (VehicleState& state : moving) {
+                state.position.lat += 1e-5;
+                state.position.lon -= 2e-5;
+                state.heading = std::fmod(state.heading + 0.9, 6.283185307179586);
+                state.speed = std::fmod(state.speed + 1.5, 25.0);
+                encoder.append(frame, state, tick, timestamp);
+                recordEnds.push_back(static_cast<std::uint32_t>(frame.size()));
+            }
+            finishKafkaFrame(frame, recordEnds.data(), static_cast<std::uint32_t>(recordEnds.size()));
+
+            KafkaFrameView view;
+            if (!view.parse(frame.data(), frame.size()) || view.size() != moving.size() || view.getTick() != tick) {
+                std::fprintf(stderr, "Kafka frame of tick %llu does not parse back\n",
+                             static_cast<unsigned long long>(tick));
+                break;
+            }
+            for (std::size_t i = 0; i < view.size() && matched; ++i) {
+                const VehicleState& state = moving[i];
+                std::int64_t heading = std::llround(state.heading * DeltaHeadingScale) % DeltaHeadingPeriod;
+                DeltaRecord record;
+                matched = decoder.decode(view[i].data(), view[i].size(), record) == DeltaDecodeStatus::Ok
+                          && record.id == state.id && record.tick == tick && record.timestamp == timestamp
+                          && record.lat == std::llround(state.position.lat * DeltaCoordinateScale) / DeltaCoordinateScale
+                          && record.lon == std::llround(state.position.lon * DeltaCoordinateScale) / DeltaCoordinateScale
+                          && record.heading == static_cast<double>(heading) / DeltaHeadingScale
+                          && record.speed == std::llround(state.speed * DeltaSpeedScale) / DeltaSpeedScale;
+                if (!matched) {
+                    std::fprintf(stderr, "Delta record of %s at tick %llu decodes differently\n",
+                                 std::string(state.id).c_str(), static_cast<unsigned long long>(tick));
+                }
+            }
+        }
+    }
+
+    // Publish one record per iteration, then wait for every delivery report
+    auto publishBench = [states, records](KafkaEncoding encoding, const MockKafkaConfig& broker,
+                                          int aggregatePartitions = 0, size_t aggregateMaxBytes = 900 << 10) {
+        return [states, records, encoding, broker, aggregatePartitions, aggregateMaxBytes](std::size_t iterations) {
+            KafkaConfig config;
+            config.encoding = encoding;
+            config.aggregatePartitions = aggregatePartitions;
+            config.aggregateMaxBytes = aggregateMaxBytes;
+            config.queueMaxMessages = static_cast<int>(broker.queueMaxMessages);
+            config.pollIntervalMs = 1;
+            auto backend = std::make_unique<MockKafkaBackend>(broker);
+            MockKafkaBackend* mock = backend.get(); // Owned by the publisher
+            KafkaPublisher publisher(std::move(backend), config);
+            // A tick of 1024 vehicles per publish call, encoded as the dispatcher does
+            VehicleJsonSerializer serializer;
+            std::string json;
+            std::vector<std::uint32_t> jsonOffsets;
+            bool needsJson = publisher.getPayloadFormat() == PayloadFormat::Json;
+            for (std::size_t i = 0; i < iterations; i += 1024) {
+                std::size_t count = std::min<std::size_t>(1024, iterations - i);
+                json.clear();
+                jsonOffsets.assign(1, 0);
+                for (std::size_t j = 0; j < count; ++j) {
+                    VehicleRecord& record = (*records)[j];
+                    record.tick = i >> 10;
+                    if (needsJson) {
+                        serializer.append(json, record.state, record.timestamp);
+                        jsonOffsets.push_back(static_cast<std::uint32_t>(json.size()));
+                    }
+                }
+                TickInfo info{i >> 10, 0.0, 0.1, 1700000000};
+                publisher.publish({info, records->data(), count, json, jsonOffsets.data()});
+            }
+            publisher.flush(60000);
+            benchSink = publisher.getStats().delivered;
+
+            // Frames past the limit would be rejected by a real broker
+            if (aggregatePartitions > 0 && mock->getStats().maxMessageBytes > config.aggregateMaxBytes) {
+                std::fprintf(stderr, "Kafka frame of %zu bytes exceeds the %zu byte limit\n",
+                             mock->getStats().maxMessageBytes, config.aggregateMaxBytes);
+            }
+        };
+    };
+
+    MockKafkaConfig instant;
+    instant.ackLatencyMs = 0.0;
+    instant.verifyPayloads = false;
+
+    // A 20 MB/s link with a small queue: publishing is throttled by bytes on the wire
+    MockKafkaConfig narrowLink = instant;
+    narrowLink.ackLatencyMs = 1.0;
+    narrowLink.bytesPerSecond = 20e6;
+    narrowLink.queueMaxMessages = 10000;
+
+    std::vector<Benchmark> benchmarks;
+    benchmarks.push_back({"kafkaPublish/json", publishBench(KafkaEncoding::Json, instant)});
+    benchmarks.push_back({"kafkaPublish/delta", publishBench(KafkaEncoding::Delta, instant)});
+    benchmarks.push_back({"kafkaPublish/json/aggregated", publishBench(KafkaEncoding::Json, instant, 6)});
+    benchmarks.push_back({"kafkaPublish/delta/aggregated", publishBench(KafkaEncoding::Delta, instant, 6)});
+    // Frames far smaller than a tick, so most are sent early at the size limit
+    benchmarks.push_back({"kafkaPublish/delta/aggregated/small-frames",
+                          publishBench(KafkaEncoding::Delta, instant, 1, 2048)});
+    benchmarks.push_back({"kafkaPublish/json/narrow-link", publishBench(KafkaEncoding::Json, narrowLink)});
+    benchmarks.push_back({"kafkaPublish/delta/narrow-link", publishBench(KafkaEncoding::Delta, narrowLink)});
+    return benchmarks;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    std::string filter;
+    bool jsonOutput = false;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--json") {
+            jsonOutput = true;
+        } else {
+            filter = arg;
+        }
+    }
+
+    std::vector<Benchmark> benchmarks = simulationBenchmarks();
+    for (Benchmark& benchmark : serializerBenchmarks()) {
+        benchmarks.push_back(std::move(benchmark));
+    }
+    for (Benchmark& benchmark : kafkaBenchmarks()) {
+        benchmarks.push_back(std::move(benchmark));
+    }
+
+    json results = json::array();
+    if (!jsonOutput) {
+        std::printf("%-44s %12s %12s\n", "benchmark", "ns/op", "allocs/op");
+    }
+    for (const Benchmark& benchmark : benchmarks) {
+        if (benchmark.name.find(filter) == std::string::npos) {
+            continue;
+        }
+        BenchResult result = measure(benchmark);
+        if (jsonOutput) {
+            results.push_back({
+                    {"name", benchmark.name},
+                    {"iterations", result.iterations},
+                    {"nsPerOp", result.nanosPerOp},
+                    {"allocationsPerOp", result.allocationsPerOp}
+            });
+        } else {
+            std::printf("%-44s %12.1f %12.3f\n", benchmark.name.c_str(), result.nanosPerOp,
+                        result.allocationsPerOp);
+            std::fflush(stdout);
+        }
+    }
+
+    if (jsonOutput) {
+        json report = {
+                {"seed", BenchSeed},
+                {"benchmarks", results}
+        };
+        std::printf("%s\n", report.dump(2).c_str());
+    }
+    return 0;
+}
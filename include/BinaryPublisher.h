@@ -0,0 +1,65 @@
+#ifndef VEHICLE_SIM_BINARY_PUBLISHER_H
+#define VEHICLE_SIM_BINARY_PUBLISHER_H
+
+#include "Publisher.h"
+#include "TelemetryFormat.h"
+#include "TickSnapshot.h"
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// Class for publishing vehicle updates to a binary telemetry file.
+//
+// Writes the fixed-width format from TelemetryFormat.h: 24 bytes per update
+// instead of roughly 110 for JSON. Records are packed into a large buffer
+// and written in one call per flush; the id dictionary and final header are
+// written when the publisher is destroyed (or close() is called).
+class BinaryPublisher : public Publisher {
+public:
+    // Constructor with output file path, the simulation time step (stored
+    // in the header) and the number of buffered bytes that triggers a write
+    BinaryPublisher(const std::string& outputFilePath, double timeStep, size_t flushBytes = 1 << 20);
+
+    // Destructor closes the file
+    ~BinaryPublisher() override;
+
+    BinaryPublisher(const BinaryPublisher&) = delete;
+    BinaryPublisher& operator=(const BinaryPublisher&) = delete;
+
+    // Publish a dispatcher batch; packs the raw records itself
+    bool publish(const PublishBatch& batch) override;
+
+    // Write everything buffered so far to the file
+    bool flush() override;
+
+    // Write the dictionary and final header and close the file
+    bool close();
+
+    // Getters
+    std::uint64_t getRecordsWritten() const { return header_.recordCount; }
+    size_t getVehicleCount() const { return ids_.size(); }
+
+private:
+    std::string outputFilePath_;
+    std::ofstream outputFile_;
+    size_t flushBytes_;
+
+    TelemetryHeader header_;
+    bool hasFirstTimestamp_;
+
+    std::vector<unsigned char> buffer_; // Packed records not yet written
+    size_t buffered_;                   // Bytes used in buffer_
+
+    // Dense vehicle index per handle and the ids in index order
+    std::vector<std::uint32_t> indexByHandle_;
+    std::vector<std::string> ids_;
+
+    // Pack one state into the buffer
+    bool appendRecord(const VehicleState& state, std::uint64_t tick, std::time_t timestamp);
+
+    // Dense index of a vehicle, assigning the next one on first sight
+    std::uint32_t vehicleIndex(const VehicleState& state);
+};
+
+#endif // VEHICLE_SIM_BINARY_PUBLISHER_H
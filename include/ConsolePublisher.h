@@ -0,0 +1,76 @@
+#ifndef VEHICLE_SIM_CONSOLE_PUBLISHER_H
+#define VEHICLE_SIM_CONSOLE_PUBLISHER_H
+
+#include "Publisher.h"
+#include "VehicleSerializer.h"
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+class PublishDispatcher;
+
+// What the console prints
+struct ConsoleConfig {
+    double intervalSeconds = 1.0;              // Period of the summary line; 0 disables it
+    std::unordered_set<std::string> sampleIds; // Vehicles printed on every update
+    std::uint64_t sampleEvery = 0;             // Also print one update in this many; 0 disables
+};
+
+// Console output as a dispatcher sink.
+//
+// Prints a one-line summary per interval (tick rate, vehicles, update
+// rate, deepest sink queue) and, optionally, sampled updates as compact
+// JSON lines. Runs on its own sink thread like any other publisher, so
+// the simulation never waits on the terminal; output of a publish call is
+// written in one piece and only flushed by flush().
+class ConsolePublisher : public Publisher {
+public:
+    // Constructor with the settings and the stream to print to
+    explicit ConsolePublisher(const ConsoleConfig& config, std::ostream& out);
+
+    // Report sink queue depths from this dispatcher in the summary
+    void setDispatcher(const PublishDispatcher* dispatcher) { dispatcher_ = dispatcher; }
+
+    // Summarize and sample a dispatcher batch
+    bool publish(const PublishBatch& batch) override;
+
+    // Flush the stream
+    bool flush() override;
+
+    // Getters
+    std::uint64_t getLinesPrinted() const { return linesPrinted_; }
+
+private:
+    ConsoleConfig config_;
+    std::ostream& out_;
+    const PublishDispatcher* dispatcher_;
+    VehicleJsonSerializer serializer_;
+    std::string buffer_; // Lines of the current publish call
+
+    // Sampling decision per handle, checked against the id's storage
+    struct CachedSample {
+        const char* source = nullptr;
+        bool sampled = false;
+    };
+    std::vector<CachedSample> sampleCache_;
+
+    // Totals, and their values at the last summary
+    std::uint64_t ticks_;
+    std::uint64_t updates_;
+    std::uint64_t vehicles_; // Updates in the latest tick
+    std::uint64_t ticksAtSummary_;
+    std::uint64_t updatesAtSummary_;
+    std::chrono::steady_clock::time_point summaryAt_;
+    std::uint64_t linesPrinted_;
+
+    // Is this update sampled; sequence counts every update seen
+    bool sampled(const VehicleState& state, std::uint64_t sequence);
+
+    // Append the summary line for the interval ending now
+    void appendSummary(const TickInfo& info, std::chrono::steady_clock::time_point now);
+};
+
+#endif // VEHICLE_SIM_CONSOLE_PUBLISHER_H
@@ -0,0 +1,87 @@
+#ifndef VEHICLE_SIM_DEAD_RECKONING_FILTER_H
+#define VEHICLE_SIM_DEAD_RECKONING_FILTER_H
+
+#include "LocalProjection.h"
+#include "TickSnapshot.h"
+#include <cstdint>
+#include <vector>
+
+// When a vehicle's update is worth publishing
+struct DeadReckoningConfig {
+    double distanceThreshold = 5.0;   // Metres between actual and predicted position
+    double headingThreshold = 0.1745; // Radians (10°) between actual and reported heading
+    double maxIntervalSeconds = 10.0; // Heartbeat: simulation seconds between reports at most
+};
+
+// Filter counters
+struct DeadReckoningStats {
+    std::uint64_t considered = 0; // Vehicle updates seen
+    std::uint64_t published = 0;  // Updates let through
+    std::uint64_t heartbeats = 0; // Of those, sent only because the interval expired
+    std::uint64_t invalidated = 0; // Reports forgotten because a sink dropped them
+
+    // Fraction of updates suppressed
+    double suppressionRatio() const {
+        return considered > 0 ? 1.0 - static_cast<double>(published) / static_cast<double>(considered) : 0.0;
+    }
+};
+
+// Suppresses vehicle updates a consumer can predict.
+//
+// Keeps the last published state of every vehicle and extrapolates it in a
+// straight line at the reported heading and speed. An update is only
+// published when the actual position is further than distanceThreshold
+// from that prediction, the heading has turned by more than
+// headingThreshold, or maxIntervalSeconds have passed since the last
+// report. A consumer running the same extrapolation between reports is
+// therefore never more than distanceThreshold off at any tick, while
+// parked vehicles and straight runs cost one message per heartbeat.
+//
+// That bound assumes every published update reaches the consumer. The
+// filter records an update as reported when it lets it through, before
+// any sink has accepted it, so a sink that drops ticks (DropOldest or
+// Sample backpressure) leaves its consumers extrapolating from an older
+// report. Call invalidate() for the updates of every dropped tick: each
+// affected vehicle is then published again on its next update, and the
+// bound is restored one tick after the drop. Losses inside a sink, such
+// as Kafka messages dropped on a full queue, are not seen here and are
+// only repaired by the next heartbeat.
+class DeadReckoningFilter {
+public:
+    // Constructor with the thresholds
+    explicit DeadReckoningFilter(const DeadReckoningConfig& config = DeadReckoningConfig());
+
+    // Filter a tick; the returned snapshot is valid until the next call
+    TickSnapshot filter(const TickSnapshot& snapshot);
+
+    // Decide for one update, recording it as the last report if published
+    bool shouldPublish(const VehicleState& state, double simulationTime);
+
+    // An update published at simulationTime never reached a consumer:
+    // unless the vehicle has been reported since, publish it again next time
+    void invalidate(VehicleHandle handle, double simulationTime);
+
+    // Forget every vehicle, so each is published again on its next update
+    void reset();
+
+    // Getters
+    const DeadReckoningConfig& getConfig() const { return config_; }
+    const DeadReckoningStats& getStats() const { return stats_; }
+
+private:
+    // Last published state of one vehicle
+    struct LastReport {
+        bool valid = false;
+        LocalProjection frame; // Plane centred on the reported position
+        double heading = 0.0;
+        double speed = 0.0;
+        double time = 0.0;     // Simulation time of the report
+    };
+
+    DeadReckoningConfig config_;
+    DeadReckoningStats stats_;
+    std::vector<LastReport> reports_; // Indexed by vehicle handle
+    std::vector<VehicleState> kept_;  // States of the last filtered tick
+};
+
+#endif // VEHICLE_SIM_DEAD_RECKONING_FILTER_H
@@ -0,0 +1,166 @@
+#ifndef VEHICLE_SIM_DELTA_CODEC_H
+#define VEHICLE_SIM_DELTA_CODEC_H
+
+#include "TickSnapshot.h"
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Compact delta wire format for vehicle updates, version 1.
+//
+// Every message starts with a kind byte and the vehicle index (the
+// simulation's vehicle handle) as an unsigned LEB128 varint:
+//
+//   keyframe  0x01 index tick timestamp lat lon heading speed idLength id
+//   delta     0x02 index tick timestamp lat lon heading speed
+//
+// In a keyframe tick and heading are unsigned varints, timestamp, lat, lon
+// and speed zigzag varints, followed by the UTF-8 id. In a delta every
+// field is a zigzag varint holding the difference from the vehicle's
+// previous message. Values are quantized before differencing, so decoding
+// never drifts:
+//
+//   lat, lon  1e-7 degrees (about 1 cm)
+//   heading   1e-4 radians in [0, 2pi); deltas take the short way round
+//   speed     1e-2 m/s
+//
+// A delta only makes sense after the keyframe it builds on; a decoder that
+// joins mid-stream skips deltas of a vehicle until its next keyframe.
+
+constexpr std::uint8_t DeltaKeyframe = 0x01;
+constexpr std::uint8_t DeltaUpdate = 0x02;
+
+constexpr double DeltaCoordinateScale = 1e7;
+constexpr double DeltaHeadingScale = 1e4;
+constexpr double DeltaSpeedScale = 1e2;
+
+// Heading steps in a full turn
+constexpr std::int64_t DeltaHeadingPeriod = 62832; // round(2pi * 1e4)
+
+// Zigzag mapping: small magnitudes of either sign become small unsigned values
+inline std::uint64_t zigzagEncode(std::int64_t value) {
+    return (static_cast<std::uint64_t>(value) << 1) ^ static_cast<std::uint64_t>(value >> 63);
+}
+
+inline std::int64_t zigzagDecode(std::uint64_t value) {
+    return static_cast<std::int64_t>(value >> 1) ^ -static_cast<std::int64_t>(value & 1);
+}
+
+// Append an unsigned LEB128 varint
+inline void appendVarint(std::string& out, std::uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<char>((value & 0x7f) | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<char>(value));
+}
+
+// Read an unsigned LEB128 varint; returns false if it runs past end
+inline bool readVarint(const unsigned char*& in, const unsigned char* end, std::uint64_t& value) {
+    value = 0;
+    for (int shift = 0; shift < 64 && in < end; shift += 7) {
+        unsigned char byte = *in++;
+        value |= static_cast<std::uint64_t>(byte & 0x7f) << shift;
+        if ((byte & 0x80) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// One decoded vehicle update
+struct DeltaRecord {
+    std::uint32_t vehicleIndex = 0;
+    std::string_view id;       // Valid until the decoder sees the vehicle's next keyframe
+    std::uint64_t tick = 0;
+    std::int64_t timestamp = 0;
+    double lat = 0.0;
+    double lon = 0.0;
+    double heading = 0.0;      // Radians in [0, 2pi)
+    double speed = 0.0;        // m/s
+    bool keyframe = false;
+};
+
+// Outcome of decoding one message
+enum class DeltaDecodeStatus {
+    Ok,
+    NeedKeyframe, // Delta for a vehicle whose keyframe has not been seen
+    Malformed     // Truncated message or unknown kind
+};
+
+// Encodes vehicle updates as keyframes and deltas.
+//
+// Keeps the last quantized values sent for every vehicle, indexed by
+// handle. A vehicle gets a keyframe on its first message, every
+// keyframeInterval messages after that, and after forceKeyframes(), which
+// a publisher calls when messages may have been lost. Not thread-safe.
+class DeltaEncoder {
+public:
+    // Constructor with the number of deltas allowed between keyframes (0: keyframes only)
+    explicit DeltaEncoder(std::uint32_t keyframeInterval = 100);
+
+    // Append the message for a state
+    void append(std::string& out, const VehicleState& state, std::uint64_t tick, std::time_t timestamp);
+
+    // Send the next message of every vehicle as a keyframe
+    void forceKeyframes();
+
+    // Messages encoded so far
+    std::uint64_t getKeyframeCount() const { return keyframes_; }
+    std::uint64_t getDeltaCount() const { return deltas_; }
+
+private:
+    struct Quantized {
+        std::uint64_t tick = 0;
+        std::int64_t timestamp = 0;
+        std::int64_t lat = 0;
+        std::int64_t lon = 0;
+        std::int64_t heading = 0;
+        std::int64_t speed = 0;
+    };
+
+    struct Previous {
+        Quantized values;
+        std::uint32_t sinceKeyframe = 0; // Deltas since the last keyframe
+        std::uint64_t generation = 0;    // forceKeyframes() count when last encoded; 0 if never
+    };
+
+    std::uint32_t keyframeInterval_;
+    std::uint64_t generation_;
+    std::vector<Previous> previous_; // Indexed by vehicle handle
+    std::uint64_t keyframes_;
+    std::uint64_t deltas_;
+};
+
+// Decodes a stream of keyframes and deltas.
+//
+// Messages of one vehicle must be fed in the order they were encoded; Kafka
+// keeps that order within a partition, and vehicles are keyed by id. Not
+// thread-safe.
+class DeltaDecoder {
+public:
+    // Decode one message into record
+    DeltaDecodeStatus decode(const void* data, size_t size, DeltaRecord& record);
+
+    // Forget every vehicle
+    void reset() { vehicles_.clear(); }
+
+private:
+    struct Vehicle {
+        bool valid = false;
+        std::string id;
+        std::uint64_t tick = 0;
+        std::int64_t timestamp = 0;
+        std::int64_t lat = 0;
+        std::int64_t lon = 0;
+        std::int64_t heading = 0;
+        std::int64_t speed = 0;
+    };
+
+    std::vector<Vehicle> vehicles_; // Indexed by vehicle index
+};
+
+#endif // VEHICLE_SIM_DELTA_CODEC_H
@@ -0,0 +1,130 @@
+#ifndef VEHICLE_SIM_DYNAMICS_KERNEL_H
+#define VEHICLE_SIM_DYNAMICS_KERNEL_H
+
+#include "Route.h"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+// Instruction set used to advance the fleet
+enum class KernelIsa {
+    Scalar, // One vehicle at a time with libm trig (reference path)
+    SSE2,   // 2 vehicles per instruction
+    AVX2,   // 4 vehicles per instruction, with FMA
+    AVX512  // 8 vehicles per instruction
+};
+
+// Raw view of the per-slot arrays the dynamics kernels read and write.
+// Positions and distances are in metres on the fleet's local plane.
+struct FleetKernelView {
+    double* x;        // East
+    double* y;        // North
+    double* heading;
+    double* speed;
+    const double* maxSpeed;
+    const double* acceleration;
+    const double* deceleration;
+    const double* waypointThreshold;
+    const double* targetX;
+    const double* targetY;
+    const std::uint8_t* completed;
+    std::uint8_t* reached;  // Set to 1 for slots that reached their waypoint this step
+};
+
+// Largest difference between the scalar and a batched kernel over a range
+struct KernelDiff {
+    double maxPositionError = 0.0; // Metres
+    double maxHeadingError = 0.0;  // Radians, wrapped to [0, π]
+    double maxSpeedError = 0.0;    // m/s
+    size_t waypointMismatches = 0; // Slots where only one kernel reached the waypoint
+    size_t vehiclesCompared = 0;
+};
+
+// Best instruction set supported by the running CPU
+KernelIsa detectKernelIsa();
+
+// Clamp a requested instruction set to what this build and CPU support
+KernelIsa resolveKernelIsa(KernelIsa requested);
+
+// Human-readable instruction set name
+const char* kernelIsaName(KernelIsa isa);
+
+// Vehicles per instruction of an instruction set (1 for the scalar path)
+size_t kernelIsaWidth(KernelIsa isa);
+
+// Advance slots [begin, end) by one time step with the given instruction set.
+// Returns the number of slots that reached their waypoint; the caller is
+// responsible for stepping their routes.
+size_t advanceFleetBatch(KernelIsa isa, const FleetKernelView& view,
+                         size_t begin, size_t end, double deltaTime);
+
+// Run both the scalar and the given kernel on copies of slots [begin, end)
+// and report how far apart they end up. The view is not modified.
+KernelDiff compareKernels(KernelIsa isa, const FleetKernelView& view,
+                          size_t begin, size_t end, double deltaTime);
+
+// Reference dynamics step for one slot; returns true if the waypoint was reached
+inline bool stepVehicleScalar(const FleetKernelView& view, size_t slot, double deltaTime) {
+    // Skip update if route is completed
+    if (view.completed[slot]) {
+        view.speed[slot] = 0.0;
+        return false;
+    }
+
+    LocalPoint position{view.x[slot], view.y[slot]};
+    LocalPoint targetWaypoint{view.targetX[slot], view.targetY[slot]};
+
+    // Calculate heading to waypoint (0 = north, increases clockwise)
+    double targetHeading = std::atan2(targetWaypoint.x - position.x,
+                                      targetWaypoint.y - position.y);
+
+    // Gradually adjust current heading towards target
+    double heading = view.heading[slot];
+    double headingDiff = targetHeading - heading;
+    while (headingDiff > M_PI) headingDiff -= 2 * M_PI;
+    while (headingDiff < -M_PI) headingDiff += 2 * M_PI;
+    heading += headingDiff * 2.0 * deltaTime;
+    while (heading > 2 * M_PI) heading -= 2 * M_PI;
+    while (heading < 0) heading += 2 * M_PI;
+    view.heading[slot] = heading;
+
+    // Adjust speed based on proximity to waypoint; the square root is only
+    // needed inside the slow-down radius
+    double threshold = view.waypointThreshold[slot];
+    double maxSpeed = view.maxSpeed[slot];
+    double slowRadius = 3 * threshold;
+    double distanceSquared = position.squaredDistanceTo(targetWaypoint);
+    double targetSpeed = maxSpeed;
+    if (distanceSquared < slowRadius * slowRadius) {
+        targetSpeed = maxSpeed * (std::sqrt(distanceSquared) / slowRadius);
+    }
+
+    double speed = view.speed[slot];
+    if (speed > 0) {
+        if (speed < targetSpeed) {
+            speed += view.acceleration[slot] * deltaTime;
+            if (speed > targetSpeed) speed = targetSpeed;
+        } else if (speed > targetSpeed) {
+            speed -= view.deceleration[slot] * deltaTime;
+            if (speed < targetSpeed) speed = targetSpeed;
+        }
+    } else {
+        // Starting from stop
+        speed = std::min(view.acceleration[slot] * deltaTime, targetSpeed);
+    }
+    speed = std::max(0.0, std::min(speed, maxSpeed));
+    view.speed[slot] = speed;
+
+    // Move vehicle based on current speed and heading
+    double step = speed * deltaTime;
+    position.x += step * std::sin(heading);
+    position.y += step * std::cos(heading);
+    view.x[slot] = position.x;
+    view.y[slot] = position.y;
+
+    // Check if vehicle reached current waypoint
+    return position.squaredDistanceTo(targetWaypoint) <= threshold * threshold;
+}
+
+#endif // VEHICLE_SIM_DYNAMICS_KERNEL_H
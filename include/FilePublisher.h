@@ -3,27 +3,176 @@
 
 #include <string>
 #include <fstream>
-#include "Vehicle.h"
-#include <nlohmann/json.hpp>
+#include <vector>
+#include <chrono>
+#include <memory>
+#include <string_view>
+#include "Publisher.h"
+#include "UringFileWriter.h"
 
-// Class for publishing vehicle updates to a file
-class FilePublisher {
+// Layout of the output file
+enum class FileFormat {
+    JsonArray, // One JSON array, closed when the publisher is destroyed
+    Ndjson     // One JSON object per line; every flush ends on a complete line
+};
+
+// When buffered records are written to the file; a limit of 0 is disabled
+struct FlushPolicy {
+    size_t bytes = 1 << 20;       // Flush once this many bytes are buffered
+    size_t records = 0;           // Flush once this many records are buffered
+    double intervalSeconds = 1.0; // Flush when the last flush is older than this (checked on publish)
+    bool everyTick = false;       // Flush at the end of every publish call
+};
+
+// How flushed bytes reach the file
+enum class FileBackend {
+    Stream, // One blocking write per flush through std::ofstream
+    IoUring // Asynchronous writes through UringFileWriter; falls back to Stream if unavailable.
+            // Whole lines are only guaranteed once flush() returns, see FilePublisher
+};
+
+// When the output is split into numbered segments; a limit of 0 is
+// disabled, and with both disabled the publisher writes a single file.
+// Segments only ever end between ticks.
+struct RotationPolicy {
+    size_t bytes = 0;                // Start a new segment once the current one holds this many bytes
+    double simulationSeconds = 0.0;  // Start a new segment once the current one spans this much simulation time
+};
+
+// One finished segment, as listed in the manifest
+struct SegmentInfo {
+    std::uint64_t index = 0;
+    std::string path;
+    std::uint64_t firstTick = 0;
+    std::uint64_t lastTick = 0;
+    double startTime = 0.0;          // Simulation time of the first tick
+    double endTime = 0.0;            // Simulation time of the last tick
+    std::uint64_t records = 0;
+    std::uint64_t vehicles = 0;      // Distinct vehicles with a record in the segment
+    std::uint64_t bytes = 0;
+};
+
+// Class for publishing vehicle updates to a file.
+//
+// Records are serialized into one large user-space buffer and written with
+// a single write call whenever the flush policy says so; the file stream's
+// own buffer is disabled so every flush is exactly one write of whole
+// records. In NDJSON mode the file is therefore always a sequence of
+// complete lines, even if the process dies between flushes; a JSON array
+// is only terminated when the publisher is destroyed.
+//
+// The io_uring backend promises less. A flush is queued as one or more
+// writes that may complete in any order, so until flush() returns the
+// file can end in a torn line or hold a gap of unwritten bytes; only
+// after flush() or close does an NDJSON file end on a complete line.
+// Direct I/O would hold back the last partial block even then, so it is
+// turned off for NDJSON output.
+//
+// With rotation, output goes to numbered segments next to the configured
+// path (positions.json becomes positions-000000.json, positions-000001.json,
+// ...). A segment is written under a ".partial" name and renamed once it
+// is complete, closed and synced, and the directory is synced after the
+// rename, so any file with a final name is whole and can be picked up
+// while the simulation runs. A segment whose rename fails keeps its
+// ".partial" name and is left out of the manifest. After every rename the
+// manifest (positions.manifest.json) is rewritten the same way; it lists
+// each finished segment's tick range, record and vehicle counts and size,
+// and is marked complete when the publisher closes.
+class FilePublisher : public Publisher {
 public:
-    // Constructor with output file path
-    explicit FilePublisher(const std::string& outputFilePath);
+    // Constructor with output file path, format, flush policy and write backend
+    explicit FilePublisher(const std::string& outputFilePath,
+                           FileFormat format = FileFormat::JsonArray,
+                           const FlushPolicy& flushPolicy = FlushPolicy(),
+                           FileBackend backend = FileBackend::Stream,
+                           const UringWriterConfig& uringConfig = UringWriterConfig(),
+                           const RotationPolicy& rotation = RotationPolicy());
 
     // Destructor
-    ~FilePublisher();
+    ~FilePublisher() override;
+
+    // Publish a dispatcher batch using its shared JSON
+    PayloadFormat getPayloadFormat() const override { return PayloadFormat::Json; }
+    bool publish(const PublishBatch& batch) override;
+
+    // Write everything buffered so far to the file
+    bool flush() override;
+
+    // Getters
+    FileFormat getFormat() const { return format_; }
+    const FlushPolicy& getFlushPolicy() const { return flushPolicy_; }
+    std::uint64_t getRecordsWritten() const { return recordsWritten_; }
+    std::uint64_t getFlushCount() const { return flushCount_; }
+    bool isRotating() const { return rotation_.bytes > 0 || rotation_.simulationSeconds > 0.0; }
+    const std::vector<SegmentInfo>& getSegments() const { return segments_; }
+
+    // Backend actually in use, after any fallback
+    FileBackend getBackend() const { return uringWriter_ ? FileBackend::IoUring : FileBackend::Stream; }
 
-    // Publish vehicle update
-    bool publishVehicleUpdate(const Vehicle& vehicle);
+    // io_uring counters; all zero with the stream backend
+    UringWriterStats getUringStats() const { return uringWriter_ ? uringWriter_->getStats() : UringWriterStats(); }
 
 private:
     std::string outputFilePath_;
     std::ofstream outputFile_;
+    std::unique_ptr<UringFileWriter> uringWriter_; // Set when the io_uring backend is in use
+    FileFormat format_;
+    FlushPolicy flushPolicy_;
+    FileBackend backend_;             // Backend asked for
+    UringWriterConfig uringConfig_;
+    RotationPolicy rotation_;
+
+    std::string buffer_;            // Serialized records not yet written
+    size_t bufferedRecords_;        // Records in buffer_
+    std::uint64_t recordsWritten_;  // Records appended so far, buffered or written
+    std::uint64_t flushCount_;      // Write calls issued
+    std::chrono::steady_clock::time_point lastFlush_;
+
+    // Current file: the single output, or the segment being written
+    SegmentInfo segment_;
+    bool segmentHasTick_;           // segment_ tick range is set
+    std::uint64_t segmentWritten_;  // Bytes of the current file handed to the backend
+    std::vector<SegmentInfo> segments_;           // Finished segments
+    std::uint64_t nextSegmentIndex_;              // Index of the next segment, advanced even if a rename fails
+    std::vector<std::uint64_t> vehicleSegment_;   // Per handle: 1 + index of the last segment it appeared in
+
+    // Hand the buffer to the backend; io_uring writes are queued, not waited for
+    bool writeBuffer();
+
+    // Append one already serialized record of a state, flushing if a size limit is reached
+    bool appendEncoded(std::string_view json, const VehicleState& state);
+
+    // Separator before a record and bookkeeping after it
+    void beginEntry();
+    bool endEntry(const VehicleState& state);
+
+    // Open a file with the configured backend and start it
+    bool openFile(const std::string& path);
+
+    // Terminate, write out and close the current file
+    bool closeFile();
+
+    // Note the tick of the next records, first starting a new segment if one is due
+    bool beginTick(std::uint64_t tick, double simulationTime);
+
+    // Finish the current segment: close, sync and rename it, then add it to segments_
+    bool finishSegment();
+
+    // Open the next segment under its partial name
+    bool startSegment();
+
+    // Rewrite the manifest through a temporary file
+    bool writeManifest(bool complete);
+
+    // Path of a segment, and of the manifest
+    std::string segmentPath(std::uint64_t index) const;
+    std::string manifestPath() const;
+
+    // Flush at the end of a publish call if the policy asks for it
+    bool finishPublish();
 
-    // Convert vehicle to JSON string
-    std::string vehicleToJson(const Vehicle& vehicle);
+    // Output file ready for writing with either backend
+    bool isOpen() const { return uringWriter_ != nullptr || outputFile_.is_open(); }
 };
 
-#endif // VEHICLE_SIM_FILE_PUBLISHER_H
\ No newline at end of file
+#endif // VEHICLE_SIM_FILE_PUBLISHER_H
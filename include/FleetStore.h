@@ -0,0 +1,324 @@
+#ifndef VEHICLE_SIM_FLEET_STORE_H
+#define VEHICLE_SIM_FLEET_STORE_H
+
+#include "DynamicsKernel.h"
+#include "Route.h"
+#include <cstdint>
+#include <deque>
+#include <limits>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Stable integer handle identifying a vehicle in a FleetStore
+using VehicleHandle = std::uint32_t;
+
+// Value returned for handles that do not refer to a vehicle
+constexpr VehicleHandle InvalidVehicleHandle = std::numeric_limits<VehicleHandle>::max();
+
+// Structure-of-arrays storage for a fleet of vehicles.
+//
+// Per-tick state (position, heading, speed, limits and the current route
+// target) lives in contiguous per-field arrays indexed by a dense slot, so
+// the update loop streams through memory instead of chasing one heap object
+// per vehicle. Ids and route geometry are cold data that the loop only
+// touches when a vehicle reaches a waypoint; the geometry itself is shared
+// between vehicles on the same route, so per-vehicle memory does not grow
+// with route length.
+//
+// The range update runs either the scalar reference step or one of the
+// batched SIMD kernels (see DynamicsKernel.h), chosen with setKernelIsa().
+//
+// Positions are kept in metres on one local tangent plane for the whole
+// store, so speeds and thresholds are in consistent units and the kernels
+// never touch degrees. The projection defaults to the first vehicle's route
+// (or position) and can be set explicitly while the store is empty. Routes
+// projected around a different origin are reprojected once per geometry
+// and shared from then on.
+//
+// Handles are handed out monotonically and never reused, so a handle stays
+// valid (or reports as removed) for the lifetime of the store. Removing a
+// vehicle moves the last slot into the freed one; slots are therefore only
+// stable between structural changes.
+class FleetStore {
+public:
+    // Sentinel slot for handles that are not in the store
+    static constexpr size_t npos = std::numeric_limits<size_t>::max();
+
+    FleetStore() : hasProjection_(false), kernelIsa_(KernelIsa::Scalar) {}
+
+    // Add a vehicle and return its handle
+    VehicleHandle add(const std::string& id, const GeoPoint& position, const Route& route) {
+        if (!hasProjection_) {
+            const RouteGeometry& geometry = *route.getGeometry();
+            projection_ = geometry.empty() ? LocalProjection(position) : geometry.getProjection();
+            hasProjection_ = true;
+        }
+
+        LocalPoint local = projection_.toLocal(position);
+        VehicleHandle handle = static_cast<VehicleHandle>(handleToSlot_.size());
+        size_t slot = slotToHandle_.size();
+
+        handleToSlot_.push_back(slot);
+        ids_.push_back(id);
+
+        slotToHandle_.push_back(handle);
+        x_.push_back(local.x);
+        y_.push_back(local.y);
+        heading_.push_back(0.0);
+        speed_.push_back(0.0);
+        maxSpeed_.push_back(25.0);         // m/s (~55 mph)
+        acceleration_.push_back(2.0);      // m/s²
+        deceleration_.push_back(4.0);      // m/s²
+        waypointThreshold_.push_back(10.0); // m
+        targetX_.push_back(0.0);
+        targetY_.push_back(0.0);
+        completed_.push_back(0);
+        reached_.push_back(0);
+        routeGeometry_.push_back(projectedGeometry(route.getGeometry()));
+        routeCursor_.push_back(route.getCursor());
+
+        refreshRouteTarget(slot);
+        return handle;
+    }
+
+    // Remove a vehicle; returns false if the handle is unknown or already removed
+    bool remove(VehicleHandle handle) {
+        size_t slot = slotOf(handle);
+        if (slot == npos) {
+            return false;
+        }
+
+        size_t last = slotToHandle_.size() - 1;
+        if (slot != last) {
+            moveSlot(last, slot);
+        }
+
+        slotToHandle_.pop_back();
+        x_.pop_back();
+        y_.pop_back();
+        heading_.pop_back();
+        speed_.pop_back();
+        maxSpeed_.pop_back();
+        acceleration_.pop_back();
+        deceleration_.pop_back();
+        waypointThreshold_.pop_back();
+        targetX_.pop_back();
+        targetY_.pop_back();
+        completed_.pop_back();
+        reached_.pop_back();
+        routeGeometry_.pop_back();
+        routeCursor_.pop_back();
+
+        handleToSlot_[handle] = npos;
+        return true;
+    }
+
+    // Reserve capacity for the given number of vehicles
+    void reserve(size_t count) {
+        handleToSlot_.reserve(count);
+        slotToHandle_.reserve(count);
+        x_.reserve(count);
+        y_.reserve(count);
+        heading_.reserve(count);
+        speed_.reserve(count);
+        maxSpeed_.reserve(count);
+        acceleration_.reserve(count);
+        deceleration_.reserve(count);
+        waypointThreshold_.reserve(count);
+        targetX_.reserve(count);
+        targetY_.reserve(count);
+        completed_.reserve(count);
+        reached_.reserve(count);
+        routeGeometry_.reserve(count);
+        routeCursor_.reserve(count);
+    }
+
+    // Set the local projection; only possible while the store is empty
+    bool setProjection(const LocalProjection& projection) {
+        if (!empty()) {
+            return false;
+        }
+        projection_ = projection;
+        hasProjection_ = true;
+        projectedRoutes_.clear();
+        return true;
+    }
+    const LocalProjection& getProjection() const { return projection_; }
+
+    // Number of vehicles currently in the store
+    size_t size() const { return slotToHandle_.size(); }
+    bool empty() const { return slotToHandle_.empty(); }
+
+    // Handle/slot mapping
+    bool contains(VehicleHandle handle) const { return slotOf(handle) != npos; }
+    size_t slotOf(VehicleHandle handle) const {
+        return handle < handleToSlot_.size() ? handleToSlot_[handle] : npos;
+    }
+    VehicleHandle handleAt(size_t slot) const { return slotToHandle_[slot]; }
+
+    // Advance a single slot by one time step with the scalar reference step
+    void updateSlot(size_t slot, double deltaTime) {
+        if (stepVehicleScalar(kernelView(), slot, deltaTime)) {
+            advanceWaypoint(slot);
+        }
+    }
+
+    // Advance every slot in [begin, end) by one time step.
+    // Disjoint ranges may be updated concurrently.
+    void updateRange(size_t begin, size_t end, double deltaTime) {
+        FleetKernelView view = kernelView();
+
+        if (kernelIsa_ == KernelIsa::Scalar) {
+            for (size_t slot = begin; slot < end; ++slot) {
+                if (stepVehicleScalar(view, slot, deltaTime)) {
+                    advanceWaypoint(slot);
+                }
+            }
+            return;
+        }
+
+        // Batched kernel flags arrivals; route stepping stays scalar
+        if (advanceFleetBatch(kernelIsa_, view, begin, end, deltaTime) > 0) {
+            for (size_t slot = begin; slot < end; ++slot) {
+                if (reached_[slot]) {
+                    advanceWaypoint(slot);
+                }
+            }
+        }
+    }
+
+    // Select the kernel used by updateRange (clamped to what the CPU supports)
+    void setKernelIsa(KernelIsa isa) { kernelIsa_ = resolveKernelIsa(isa); }
+    KernelIsa getKernelIsa() const { return kernelIsa_; }
+
+    // Raw view of the per-slot arrays for the dynamics kernels
+    FleetKernelView kernelView() {
+        return {x_.data(), y_.data(), heading_.data(), speed_.data(),
+                maxSpeed_.data(), acceleration_.data(), deceleration_.data(),
+                waypointThreshold_.data(), targetX_.data(), targetY_.data(),
+                completed_.data(), reached_.data()};
+    }
+
+    // Per-slot getters
+    const std::string& idAt(size_t slot) const { return ids_[slotToHandle_[slot]]; }
+    GeoPoint positionAt(size_t slot) const { return projection_.toGeo(localPositionAt(slot)); }
+    LocalPoint localPositionAt(size_t slot) const { return {x_[slot], y_[slot]}; }
+    double headingAt(size_t slot) const { return heading_[slot]; }
+    double speedAt(size_t slot) const { return speed_[slot]; }
+    double maxSpeedAt(size_t slot) const { return maxSpeed_[slot]; }
+    double accelerationAt(size_t slot) const { return acceleration_[slot]; }
+    double decelerationAt(size_t slot) const { return deceleration_[slot]; }
+    Route routeAt(size_t slot) const { return Route(routeGeometry_[slot], routeCursor_[slot]); }
+    double remainingDistanceAt(size_t slot) const {
+        return routeGeometry_[slot]->remainingDistance(routeCursor_[slot], localPositionAt(slot));
+    }
+
+    // Per-slot setters
+    void setRouteAt(size_t slot, const Route& route) {
+        routeGeometry_[slot] = projectedGeometry(route.getGeometry());
+        routeCursor_[slot] = route.getCursor();
+        refreshRouteTarget(slot);
+    }
+    void setMaxSpeedAt(size_t slot, double maxSpeed) { maxSpeed_[slot] = maxSpeed; }
+    void setAccelerationAt(size_t slot, double acceleration) { acceleration_[slot] = acceleration; }
+    void setDecelerationAt(size_t slot, double deceleration) { deceleration_[slot] = deceleration; }
+
+private:
+    // Handle <-> slot mapping
+    std::vector<size_t> handleToSlot_;
+    std::vector<VehicleHandle> slotToHandle_;
+
+    // Ids are indexed by handle and never move, so references stay valid
+    std::deque<std::string> ids_;
+
+    // Hot per-slot state, positions in metres on the store's projection
+    std::vector<double> x_;
+    std::vector<double> y_;
+    std::vector<double> heading_;          // In radians, 0 = north, increases clockwise
+    std::vector<double> speed_;            // Current speed in m/s
+    std::vector<double> maxSpeed_;         // Maximum speed in m/s
+    std::vector<double> acceleration_;     // Acceleration rate in m/s²
+    std::vector<double> deceleration_;     // Deceleration rate in m/s²
+    std::vector<double> waypointThreshold_;// Distance in metres to consider waypoint reached
+
+    // Route cursor and cached current waypoint and completion flag
+    std::vector<RouteCursor> routeCursor_;
+    std::vector<double> targetX_;
+    std::vector<double> targetY_;
+    std::vector<std::uint8_t> completed_;
+
+    // Per-slot arrival flags written by the batched kernels
+    std::vector<std::uint8_t> reached_;
+
+    LocalProjection projection_;
+    bool hasProjection_;
+    KernelIsa kernelIsa_;
+
+    // Routes reprojected onto projection_, keyed by the original geometry.
+    // The original is kept alive so its address cannot be reused.
+    struct ProjectedRoute {
+        std::shared_ptr<const RouteGeometry> source;
+        std::shared_ptr<const RouteGeometry> projected;
+    };
+    std::unordered_map<const RouteGeometry*, ProjectedRoute> projectedRoutes_;
+
+    // Cold per-slot state, only touched when a waypoint is reached
+    std::vector<std::shared_ptr<const RouteGeometry>> routeGeometry_;
+
+    // Step the slot's route to its next waypoint and refresh the cursor
+    void advanceWaypoint(size_t slot) {
+        routeGeometry_[slot]->advance(routeCursor_[slot]);
+        refreshRouteTarget(slot);
+    }
+
+    // Geometry of a route on the store's projection, reprojecting it on first use
+    std::shared_ptr<const RouteGeometry> projectedGeometry(const std::shared_ptr<const RouteGeometry>& geometry) {
+        if (geometry->empty() || geometry->getProjection() == projection_) {
+            return geometry;
+        }
+
+        auto cached = projectedRoutes_.find(geometry.get());
+        if (cached != projectedRoutes_.end()) {
+            return cached->second.projected;
+        }
+
+        auto projected = std::make_shared<const RouteGeometry>(geometry->getWaypoints(), projection_);
+        projectedRoutes_.emplace(geometry.get(), ProjectedRoute{geometry, projected});
+        return projected;
+    }
+
+    // Re-read the cached route target from the slot's route
+    void refreshRouteTarget(size_t slot) {
+        const RouteGeometry& geometry = *routeGeometry_[slot];
+        LocalPoint target = geometry.empty() ? projection_.toLocal({0.0, 0.0})
+                                             : geometry.currentLocalWaypoint(routeCursor_[slot]);
+        targetX_[slot] = target.x;
+        targetY_[slot] = target.y;
+        completed_[slot] = geometry.isCompleted(routeCursor_[slot]) ? 1 : 0;
+    }
+
+    // Move every per-slot field from one slot to another
+    void moveSlot(size_t from, size_t to) {
+        VehicleHandle handle = slotToHandle_[from];
+        slotToHandle_[to] = handle;
+        handleToSlot_[handle] = to;
+
+        x_[to] = x_[from];
+        y_[to] = y_[from];
+        heading_[to] = heading_[from];
+        speed_[to] = speed_[from];
+        maxSpeed_[to] = maxSpeed_[from];
+        acceleration_[to] = acceleration_[from];
+        deceleration_[to] = deceleration_[from];
+        waypointThreshold_[to] = waypointThreshold_[from];
+        targetX_[to] = targetX_[from];
+        targetY_[to] = targetY_[from];
+        completed_[to] = completed_[from];
+        routeGeometry_[to] = std::move(routeGeometry_[from]);
+        routeCursor_[to] = routeCursor_[from];
+    }
+};
+
+#endif // VEHICLE_SIM_FLEET_STORE_H
@@ -0,0 +1,77 @@
+#ifndef VEHICLE_SIM_KAFKA_BACKEND_H
+#define VEHICLE_SIM_KAFKA_BACKEND_H
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+// Message payload encoding
+enum class KafkaEncoding {
+    Json, // One JSON object per message, as written to the output file
+    Delta // Keyframes and varint deltas, see DeltaCodec.h
+};
+
+// Producer settings; the defaults favour throughput over per-message latency
+struct KafkaConfig {
+    int lingerMs = 5;                // linger.ms: how long a batch may wait to fill
+    int batchBytes = 1 << 20;        // batch.size: largest batch per partition in bytes
+    std::string compression = "lz4"; // compression.codec: none, gzip, snappy, lz4 or zstd
+    int queueMaxMessages = 100000;   // queue.buffering.max.messages
+    std::string acks = "1";          // acks: 0, 1 or all
+    int queueFullTimeoutMs = 1000;   // How long produce waits out a full queue before dropping; 0 drops at once
+    int pollIntervalMs = 100;        // Longest the poll thread waits for delivery reports
+    KafkaEncoding encoding = KafkaEncoding::Json;
+    std::uint32_t keyframeInterval = 100; // Delta encoding: deltas per vehicle between keyframes
+    int aggregatePartitions = 0;     // 0 sends one message per update; otherwise each tick's updates are
+                                     // packed into one frame per partition of a topic with this many
+    size_t aggregateMaxBytes = 900 << 10; // Largest frame, index included; below the broker's 1 MB message limit
+};
+
+// Lets the producer's partitioner pick the partition from the key
+constexpr std::int32_t KafkaAnyPartition = -1;
+
+// Outcome of handing a message to a producer
+enum class KafkaProduceStatus {
+    Ok,        // Queued; a delivery report will follow
+    QueueFull, // The local queue is full; retry after polling
+    Error      // Rejected for good
+};
+
+// Receives delivery reports; called from whichever thread polls the producer
+class KafkaDeliveryListener {
+public:
+    virtual ~KafkaDeliveryListener() = default;
+
+    // A message was acknowledged (error empty) or failed
+    virtual void onDelivery(void* opaque, const std::string& error) = 0;
+};
+
+// The producer KafkaPublisher drives: librdkafka, or a stand-in.
+//
+// Semantics follow librdkafka's: produce() only queues the message and
+// never copies the payload, which must stay valid until the message's
+// delivery report; poll() serves delivery reports on the calling thread;
+// flush() polls until every queued message has been reported.
+class KafkaProducerBackend {
+public:
+    virtual ~KafkaProducerBackend() = default;
+
+    // Producer created and ready for produce calls
+    virtual bool isReady() const = 0;
+
+    // Set the receiver of delivery reports; call before producing
+    virtual void setDeliveryListener(KafkaDeliveryListener* listener) = 0;
+
+    // Queue one message for a partition, or KafkaAnyPartition to partition
+    // by key; error is set on Error
+    virtual KafkaProduceStatus produce(std::string_view payload, std::string_view key, std::int32_t partition,
+                                       void* opaque, std::string& error) = 0;
+
+    // Serve delivery reports, waiting up to timeoutMs for one
+    virtual void poll(int timeoutMs) = 0;
+
+    // Wait up to timeoutMs for every queued message; false if some remain
+    virtual bool flush(int timeoutMs) = 0;
+};
+
+#endif // VEHICLE_SIM_KAFKA_BACKEND_H
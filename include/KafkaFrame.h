@@ -0,0 +1,124 @@
+#ifndef VEHICLE_SIM_KAFKA_FRAME_H
+#define VEHICLE_SIM_KAFKA_FRAME_H
+
+#include "KafkaBackend.h"
+#include "TelemetryFormat.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+// Framed Kafka message carrying several vehicle updates of one tick, version 1.
+// All integers are little-endian.
+//
+//   header   24 bytes: magic "VSFR", u16 version, u8 encoding (0 JSON,
+//            1 delta), u8 reserved, u32 record count, u32 index offset,
+//            u64 tick
+//   records  the updates back to back, each encoded as a single message
+//            of the frame's encoding would be
+//   index    record count * u32: end offset of each record in the frame
+//
+// Record i spans [end of record i - 1, end of record i), the first one
+// starting right after the header. Updates of one vehicle only ever go to
+// the same partition and appear in the frame in publish order, so reading
+// a partition's frames in order gives each vehicle's updates in order.
+
+constexpr char KafkaFrameMagic[4] = {'V', 'S', 'F', 'R'};
+constexpr std::uint16_t KafkaFrameVersion = 1;
+constexpr std::size_t KafkaFrameHeaderSize = 24;
+
+// Start a frame: append a header whose count and index offset are filled in by finishKafkaFrame
+inline void beginKafkaFrame(std::string& out, KafkaEncoding encoding, std::uint64_t tick) {
+    unsigned char header[KafkaFrameHeaderSize] = {};
+    std::memcpy(header, KafkaFrameMagic, sizeof(KafkaFrameMagic));
+    storeLE16(header + 4, KafkaFrameVersion);
+    header[6] = encoding == KafkaEncoding::Delta ? 1 : 0;
+    storeLE64(header + 16, tick);
+    out.append(reinterpret_cast<const char*>(header), sizeof(header));
+}
+
+// Finish a frame started at offset 0 of out, given each record's end offset
+inline void finishKafkaFrame(std::string& out, const std::uint32_t* recordEnds, std::uint32_t recordCount) {
+    auto indexOffset = static_cast<std::uint32_t>(out.size());
+    unsigned char entry[4];
+    for (std::uint32_t i = 0; i < recordCount; ++i) {
+        storeLE32(entry, recordEnds[i]);
+        out.append(reinterpret_cast<const char*>(entry), sizeof(entry));
+    }
+    auto* header = reinterpret_cast<unsigned char*>(&out[0]);
+    storeLE32(header + 8, recordCount);
+    storeLE32(header + 12, indexOffset);
+}
+
+// Splits a received frame into its records without copying
+class KafkaFrameView {
+public:
+    // Parse a frame; returns false (and an empty view) if it is malformed
+    bool parse(const void* data, std::size_t size) {
+        const auto* frame = static_cast<const unsigned char*>(data);
+        data_ = nullptr;
+        count_ = 0;
+        if (size < KafkaFrameHeaderSize || std::memcmp(frame, KafkaFrameMagic, sizeof(KafkaFrameMagic)) != 0
+            || loadLE16(frame + 4) != KafkaFrameVersion || frame[6] > 1) {
+            return false;
+        }
+
+        std::uint32_t count = loadLE32(frame + 8);
+        std::uint32_t indexOffset = loadLE32(frame + 12);
+        if (indexOffset < KafkaFrameHeaderSize || indexOffset > size
+            || (size - indexOffset) / 4 < count) {
+            return false;
+        }
+
+        // Record ends must be increasing and stay before the index
+        std::uint32_t previous = static_cast<std::uint32_t>(KafkaFrameHeaderSize);
+        for (std::uint32_t i = 0; i < count; ++i) {
+            std::uint32_t end = loadLE32(frame + indexOffset + 4 * i);
+            if (end < previous || end > indexOffset) {
+                return false;
+            }
+            previous = end;
+        }
+
+        data_ = frame;
+        count_ = count;
+        index_ = frame + indexOffset;
+        encoding_ = frame[6] == 1 ? KafkaEncoding::Delta : KafkaEncoding::Json;
+        tick_ = loadLE64(frame + 16);
+        return true;
+    }
+
+    // Records
+    std::size_t size() const { return count_; }
+    std::string_view operator[](std::size_t i) const {
+        std::uint32_t begin = i == 0 ? static_cast<std::uint32_t>(KafkaFrameHeaderSize) : loadLE32(index_ + 4 * (i - 1));
+        std::uint32_t end = loadLE32(index_ + 4 * i);
+        return {reinterpret_cast<const char*>(data_) + begin, end - begin};
+    }
+
+    // Getters
+    KafkaEncoding getEncoding() const { return encoding_; }
+    std::uint64_t getTick() const { return tick_; }
+
+private:
+    const unsigned char* data_ = nullptr;
+    const unsigned char* index_ = nullptr;
+    std::size_t count_ = 0;
+    KafkaEncoding encoding_ = KafkaEncoding::Json;
+    std::uint64_t tick_ = 0;
+};
+
+// Partition of a vehicle id among partitionCount, as librdkafka's default
+// partitioner picks it for a keyed message (CRC32 of the key)
+inline std::int32_t kafkaPartitionOf(std::string_view key, std::int32_t partitionCount) {
+    std::uint32_t crc = 0xffffffffu;
+    for (char c : key) {
+        crc ^= static_cast<unsigned char>(c);
+        for (int bit = 0; bit < 8; ++bit) {
+            crc = (crc >> 1) ^ (0xedb88320u & (0u - (crc & 1u)));
+        }
+    }
+    return static_cast<std::int32_t>((crc ^ 0xffffffffu) % static_cast<std::uint32_t>(partitionCount));
+}
+
+#endif // VEHICLE_SIM_KAFKA_FRAME_H
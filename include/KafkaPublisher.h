@@ -1,39 +1,188 @@
 #ifndef VEHICLE_SIM_KAFKA_PUBLISHER_H
 #define VEHICLE_SIM_KAFKA_PUBLISHER_H
 
+#include <atomic>
+#include <chrono>
+#include <cstdint>
 #include <string>
 #include <memory>
-#include <librdkafka/rdkafkacpp.h>
-#include "Vehicle.h"
-#include <nlohmann/json.hpp>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <ctime>
+#include <string_view>
+#include "DeltaCodec.h"
+#include "KafkaBackend.h"
+#include "Publisher.h"
+#include "RingBuffer.h"
+#include "TickSnapshot.h"
+#include "VehicleSerializer.h"
 
-// Class for publishing vehicle updates to Kafka
-class KafkaPublisher {
+// Delivery counters
+struct KafkaPublisherStats {
+    std::uint64_t produced = 0;         // Messages accepted by the producer
+    std::uint64_t delivered = 0;        // Messages acknowledged by the broker
+    std::uint64_t failed = 0;           // Messages with a failed delivery report
+    std::uint64_t dropped = 0;          // Messages never accepted: the queue stayed full or produce failed
+    std::uint64_t queueFullRetries = 0; // Produce calls that hit a full queue
+    std::uint64_t records = 0;          // Vehicle updates carried by the messages accepted
+    std::uint64_t payloadBytes = 0;     // Payload bytes of the messages accepted
+    std::uint64_t keyframes = 0;        // Delta encoding: keyframes among the messages encoded
+    double averageLatencySeconds = 0.0; // Produce to delivery report
+    double maxLatencySeconds = 0.0;
+    size_t pooledBuffers = 0;           // Payload buffers allocated so far
+
+    std::uint64_t inFlight() const { return produced - delivered - failed; }
+};
+
+// Class for publishing vehicle updates to Kafka.
+//
+// Payloads are serialized into pooled buffers and handed to librdkafka
+// without a copy; each buffer goes back to the pool from the delivery report
+// callback, so steady-state publishing allocates nothing. Delivery reports
+// are served by a dedicated poll thread instead of the publishing thread.
+//
+// Messages go through a KafkaProducerBackend: librdkafka when built with
+// USE_KAFKA, or a stand-in such as MockKafkaBackend for offline runs.
+//
+// With the delta encoding every vehicle is sent as a keyframe now and then
+// and as a few bytes of deltas in between. Messages that may have been lost
+// (failed delivery or produce) make every vehicle's next message a keyframe,
+// and the producer is configured not to reorder a partition on retries.
+//
+// With aggregation the updates of a tick are packed into one framed message
+// per partition (see KafkaFrame.h), each vehicle going to the partition its
+// id would be keyed to, so a tick costs a message per partition instead of
+// a message per vehicle.
+class KafkaPublisher : public Publisher {
 public:
-    // Constructor with Kafka broker address and topic name
-    KafkaPublisher(const std::string& brokerAddress, const std::string& topicName);
+    // Constructor with Kafka broker address, topic name and producer settings;
+    // fails (isReady() false) in builds without librdkafka
+    KafkaPublisher(const std::string& brokerAddress, const std::string& topicName,
+                   const KafkaConfig& config = KafkaConfig());
+
+    // Constructor with the producer backend to drive and producer settings
+    explicit KafkaPublisher(std::unique_ptr<KafkaProducerBackend> backend,
+                            const KafkaConfig& config = KafkaConfig());
+
+    // Destructor flushes outstanding messages and stops the poll thread
+    ~KafkaPublisher() override;
+
+    KafkaPublisher(const KafkaPublisher&) = delete;
+    KafkaPublisher& operator=(const KafkaPublisher&) = delete;
+
+    // Publish a dispatcher batch using its shared JSON, or its records when delta encoding
+    PayloadFormat getPayloadFormat() const override {
+        return config_.encoding == KafkaEncoding::Json ? PayloadFormat::Json : PayloadFormat::Records;
+    }
+    bool publish(const PublishBatch& batch) override;
 
-    // Destructor
-    ~KafkaPublisher();
+    // Wait up to timeoutMs for outstanding messages; returns false if some remain
+    bool flush(int timeoutMs);
 
-    // Publish vehicle update
-    bool publishVehicleUpdate(const Vehicle& vehicle);
+    // Hand queued messages to the broker, waiting up to a second
+    bool flush() override { return flush(1000); }
+
+    // Counters so far
+    KafkaPublisherStats getStats() const;
+
+    // Backend created and ready
+    bool isReady() const { return backend_ && backend_->isReady(); }
 
 private:
-    std::string brokerAddress_;
-    std::string topicName_;
+    // One message payload, owned by the pool while librdkafka references it
+    struct Payload {
+        std::string data;
+        std::chrono::steady_clock::time_point producedAt;
+    };
+
+    // Returns payloads to the pool and updates the counters
+    class DeliveryReporter : public KafkaDeliveryListener {
+    public:
+        explicit DeliveryReporter(KafkaPublisher& publisher) : publisher_(publisher) {}
+        void onDelivery(void* opaque, const std::string& error) override;
+
+    private:
+        KafkaPublisher& publisher_;
+    };
+
+    KafkaConfig config_;
+
+    // Payload pool: storage owns every buffer, the ring holds the free ones
+    std::vector<std::unique_ptr<Payload>> payloadStorage_;
+    mutable std::mutex payloadStorageMutex_;
+    RingBuffer<Payload*> freePayloads_;
+
+    std::atomic<std::uint64_t> produced_;
+    std::atomic<std::uint64_t> delivered_;
+    std::atomic<std::uint64_t> failed_;
+    std::atomic<std::uint64_t> dropped_;
+    std::atomic<std::uint64_t> queueFullRetries_;
+    std::atomic<std::uint64_t> recordsProduced_;
+    std::atomic<std::uint64_t> payloadBytes_;
+    std::atomic<std::uint64_t> latencyNanosTotal_;
+    std::atomic<std::uint64_t> latencyNanosMax_;
+
+    DeliveryReporter deliveryReporter_;
+
+    // Producer the messages go through
+    std::unique_ptr<KafkaProducerBackend> backend_;
+
+    std::atomic<bool> polling_;
+    std::thread pollThread_;
+
+    VehicleJsonSerializer serializer_;
+
+    // Delta encoding state, used by the publishing thread only
+    DeltaEncoder deltaEncoder_;
+    std::atomic<bool> messagesLost_;       // Set on failures; the next delta message resyncs
+    std::atomic<std::uint64_t> keyframes_;
+
+    // Aggregation: the frame being filled for each partition, used by the publishing thread only
+    struct Frame {
+        Payload* payload = nullptr;              // nullptr until the partition gets an update
+        std::vector<std::uint32_t> recordEnds;   // End offset of each record in the frame
+        bool dropping = false;                   // No buffer came back; skip the rest of the tick
+    };
+    std::vector<Frame> frames_;
+    std::uint64_t frameTick_;
+    std::string frameRecord_;                    // Update being added to a frame
+
+    // Attach to the backend and start the poll thread
+    void start();
+
+    // Serve delivery reports until stopped
+    void pollLoop();
+
+    // Take a free payload buffer, allocating one while under the pool limit
+    Payload* acquirePayload();
+
+    // Take a payload buffer, waiting for delivery reports to return one
+    // until the deadline; nullptr (and a drop counted) if none came back
+    Payload* waitForPayload(std::chrono::steady_clock::time_point deadline);
+
+    // Hand a payload buffer back to the pool
+    void releasePayload(Payload* payload);
+
+    // Publish one update as its own message, or into its partition's frame
+    // when aggregating; json is the update already serialized, or empty
+    bool publishState(const VehicleState& state, std::uint64_t tick, std::time_t timestamp, std::string_view json);
+
+    // Append one update in the configured encoding
+    void encodeState(std::string& out, const VehicleState& state, std::uint64_t tick, std::time_t timestamp);
 
-    // Kafka producer configuration
-    std::unique_ptr<RdKafka::Conf> conf_;
+    // Add one update to the frame of its partition, producing frames of an earlier tick first
+    bool appendToFrame(const VehicleState& state, std::uint64_t tick, std::time_t timestamp, std::string_view json);
 
-    // Kafka producer instance
-    std::unique_ptr<RdKafka::Producer> producer_;
+    // Produce every frame being filled
+    bool finishFrames();
 
-    // Kafka topic handle
-    std::unique_ptr<RdKafka::Topic> topic_;
+    // Produce the frame of one partition, if it has records
+    bool finishFrame(std::int32_t partition);
 
-    // Convert vehicle to JSON string
-    std::string vehicleToJson(const Vehicle& vehicle);
+    // Produce a filled payload buffer, retrying a full queue until the deadline
+    bool producePayload(Payload* payload, std::string_view key, std::int32_t partition,
+                        std::uint32_t recordCount, std::chrono::steady_clock::time_point deadline);
 };
 
-#endif // VEHICLE_SIM_KAFKA_PUBLISHER_H
\ No newline at end of file
+#endif // VEHICLE_SIM_KAFKA_PUBLISHER_H
@@ -0,0 +1,93 @@
+#ifndef VEHICLE_SIM_LOCAL_PROJECTION_H
+#define VEHICLE_SIM_LOCAL_PROJECTION_H
+
+#include <cmath>
+
+// Represents a 2D position with latitude and longitude
+struct GeoPoint {
+    double lat;  // Latitude in degrees
+    double lon;  // Longitude in degrees
+
+    // Great-circle distance in metres (haversine on a spherical earth)
+    double distanceTo(const GeoPoint& other) const {
+        const double earthRadius = 6371008.8; // Mean earth radius in metres
+        const double toRadians = M_PI / 180.0;
+        double sinHalfLat = std::sin((other.lat - lat) * toRadians * 0.5);
+        double sinHalfLon = std::sin((other.lon - lon) * toRadians * 0.5);
+        double h = sinHalfLat * sinHalfLat
+                   + std::cos(lat * toRadians) * std::cos(other.lat * toRadians) * sinHalfLon * sinHalfLon;
+        return 2.0 * earthRadius * std::asin(std::sqrt(std::fmin(1.0, h)));
+    }
+};
+
+// Position in metres on a local tangent plane
+struct LocalPoint {
+    double x;  // East of the projection origin
+    double y;  // North of the projection origin
+
+    // Squared planar distance, for comparisons without a square root
+    double squaredDistanceTo(const LocalPoint& other) const {
+        double dx = other.x - x;
+        double dy = other.y - y;
+        return dx * dx + dy * dy;
+    }
+
+    // Planar distance in metres
+    double distanceTo(const LocalPoint& other) const {
+        return std::sqrt(squaredDistanceTo(other));
+    }
+};
+
+// Local east-north-up tangent-plane projection around an origin.
+//
+// Uses the WGS84 meridional and prime-vertical radii of curvature at the
+// origin, so metres per degree are constant across the plane and both
+// directions are a single multiply-add. The east-west scale error grows
+// with the north-south offset from the origin (about 0.13% per 10 km at
+// 40° latitude), which is fine for a city-scale scenario; pick the origin
+// near the middle of the area being simulated.
+class LocalProjection {
+public:
+    // Constructor with the origin of the plane
+    explicit LocalProjection(const GeoPoint& origin = {0.0, 0.0})
+            : origin_(origin) {
+        const double semiMajorAxis = 6378137.0;         // WGS84 a
+        const double eccentricitySquared = 6.69437999014e-3; // WGS84 e²
+        const double toRadians = M_PI / 180.0;
+
+        double sinLat = std::sin(origin.lat * toRadians);
+        double w = 1.0 - eccentricitySquared * sinLat * sinLat;
+        double meridionalRadius = semiMajorAxis * (1.0 - eccentricitySquared) / (w * std::sqrt(w));
+        double primeVerticalRadius = semiMajorAxis / std::sqrt(w);
+
+        metresPerDegreeLat_ = meridionalRadius * toRadians;
+        metresPerDegreeLon_ = primeVerticalRadius * std::cos(origin.lat * toRadians) * toRadians;
+    }
+
+    // Project a geographic position onto the plane
+    LocalPoint toLocal(const GeoPoint& point) const {
+        return {(point.lon - origin_.lon) * metresPerDegreeLon_,
+                (point.lat - origin_.lat) * metresPerDegreeLat_};
+    }
+
+    // Convert a position on the plane back to latitude and longitude
+    GeoPoint toGeo(const LocalPoint& point) const {
+        return {origin_.lat + point.y / metresPerDegreeLat_,
+                origin_.lon + point.x / metresPerDegreeLon_};
+    }
+
+    // Getters
+    const GeoPoint& getOrigin() const { return origin_; }
+
+    bool operator==(const LocalProjection& other) const {
+        return origin_.lat == other.origin_.lat && origin_.lon == other.origin_.lon;
+    }
+    bool operator!=(const LocalProjection& other) const { return !(*this == other); }
+
+private:
+    GeoPoint origin_;
+    double metresPerDegreeLat_;
+    double metresPerDegreeLon_;
+};
+
+#endif // VEHICLE_SIM_LOCAL_PROJECTION_H
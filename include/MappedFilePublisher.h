@@ -0,0 +1,105 @@
+#ifndef VEHICLE_SIM_MAPPED_FILE_PUBLISHER_H
+#define VEHICLE_SIM_MAPPED_FILE_PUBLISHER_H
+
+#include "Publisher.h"
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+// How msync is asked to write mapped pages back
+enum class SyncMode {
+    None,  // Leave writeback to the kernel; msync is never called
+    Async, // MS_ASYNC: schedule writeback and return
+    Sync   // MS_SYNC: wait until the pages are on disk
+};
+
+// When written bytes are synced; a limit of 0 is disabled. A window is
+// always synced with the chosen mode before it is unmapped, and the whole
+// file when the publisher closes.
+struct MsyncPolicy {
+    SyncMode mode = SyncMode::Async;
+    size_t bytes = 0;             // Sync once this many bytes are unsynced
+    double intervalSeconds = 1.0; // Sync when the last sync is older than this (checked on publish)
+    bool everyPublish = false;    // Sync at the end of every publish call
+};
+
+// Mapping and preallocation sizes
+struct MappedFileConfig {
+    size_t extentBytes = 64 << 20; // File growth step, allocated with posix_fallocate
+    size_t windowBytes = 16 << 20; // Size of the mapped window (rounded to whole pages)
+    MsyncPolicy sync;
+};
+
+// Class for publishing vehicle updates to an NDJSON file through a memory mapping.
+//
+// The file is preallocated in large extents and a window of it is mapped
+// shared; records are copied straight into the mapping, so publishing makes
+// no system calls except when the window moves on (once per windowBytes)
+// or the sync policy fires. The preallocated tail is trimmed when the
+// publisher closes. After a crash the file ends in zero bytes past the last
+// record; every line before them is complete.
+class MappedFilePublisher : public Publisher {
+public:
+    // Constructor with output file path and mapping settings
+    explicit MappedFilePublisher(const std::string& outputFilePath,
+                                 const MappedFileConfig& config = MappedFileConfig());
+
+    // Destructor syncs, trims and closes the file
+    ~MappedFilePublisher() override;
+
+    MappedFilePublisher(const MappedFilePublisher&) = delete;
+    MappedFilePublisher& operator=(const MappedFilePublisher&) = delete;
+
+    // Publish a dispatcher batch using its shared JSON
+    PayloadFormat getPayloadFormat() const override { return PayloadFormat::Json; }
+    bool publish(const PublishBatch& batch) override;
+
+    // Sync everything written so far with the policy's mode
+    bool flush() override;
+
+    // Sync, unmap, trim the preallocated tail and close the file
+    bool close();
+
+    // Getters
+    bool isOpen() const { return fd_ >= 0; }
+    std::uint64_t getBytesWritten() const { return writeOffset_; }
+    std::uint64_t getRecordsWritten() const { return recordsWritten_; }
+    std::uint64_t getRemapCount() const { return remapCount_; }
+    std::uint64_t getSyncCount() const { return syncCount_; }
+
+private:
+    std::string outputFilePath_;
+    MappedFileConfig config_;
+    size_t pageSize_;
+
+    int fd_;
+    std::uint64_t allocatedSize_; // Bytes preallocated on disk
+
+    char* window_;                // Start of the mapping, or nullptr
+    std::uint64_t windowOffset_;  // File offset of window_
+    size_t windowSize_;
+    std::uint64_t writeOffset_;   // File offset of the next byte
+    std::uint64_t syncedOffset_;  // Bytes before this offset have been synced
+
+    std::uint64_t recordsWritten_;
+    std::uint64_t remapCount_;
+    std::uint64_t syncCount_;
+    std::chrono::steady_clock::time_point lastSync_;
+
+    // Make room for bytes at the write offset, moving the window if needed
+    bool reserve(size_t bytes);
+
+    // Grow the preallocated file to cover end
+    bool allocate(std::uint64_t end);
+
+    // Sync the unsynced part of the current window
+    bool syncWindow(SyncMode mode);
+
+    // Sync at the end of a publish call if the policy asks for it
+    bool finishPublish();
+
+    // Unmap the current window
+    void unmapWindow();
+};
+
+#endif // VEHICLE_SIM_MAPPED_FILE_PUBLISHER_H
@@ -0,0 +1,88 @@
+#ifndef VEHICLE_SIM_MOCK_KAFKA_BACKEND_H
+#define VEHICLE_SIM_MOCK_KAFKA_BACKEND_H
+
+#include "KafkaBackend.h"
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <random>
+
+// Simulated broker behaviour
+struct MockKafkaConfig {
+    double ackLatencyMs = 2.0;       // Time from the end of transmission to the delivery report
+    double ackJitterMs = 0.0;        // Uniform extra latency in [0, jitter)
+    double bytesPerSecond = 0.0;     // Link bandwidth messages queue behind; 0 is unlimited
+    double failureRate = 0.0;        // Fraction of messages whose delivery report is a failure
+    size_t queueMaxMessages = 100000; // Local queue limit; produce reports QueueFull beyond it
+    bool verifyPayloads = true;      // Checksum payloads at produce and at report
+    std::uint32_t seed = 1;          // Seed of the jitter and failure draws
+};
+
+// Broker-side counters
+struct MockKafkaStats {
+    std::uint64_t accepted = 0;  // Messages queued by produce
+    std::uint64_t rejected = 0;  // Produce calls refused with QueueFull
+    std::uint64_t delivered = 0; // Successful delivery reports
+    std::uint64_t failed = 0;    // Injected delivery failures
+    std::uint64_t bytesDelivered = 0;
+    size_t maxQueued = 0;
+    size_t maxMessageBytes = 0;  // Largest payload accepted
+};
+
+// In-process stand-in for a Kafka producer and broker.
+//
+// Messages queue behind a link of the configured bandwidth, are
+// acknowledged after the configured latency and reported by poll() once
+// due, in produce order, with a configurable share of them failing. The
+// local queue limit gives the same QueueFull backpressure as librdkafka.
+// Payloads are not copied, exactly as with librdkafka, so a publisher that
+// recycles a buffer too early is caught by the payload checksum. Thread-safe.
+class MockKafkaBackend : public KafkaProducerBackend {
+public:
+    // Constructor with the simulated broker behaviour
+    explicit MockKafkaBackend(const MockKafkaConfig& config = MockKafkaConfig());
+
+    bool isReady() const override { return true; }
+    void setDeliveryListener(KafkaDeliveryListener* listener) override;
+    KafkaProduceStatus produce(std::string_view payload, std::string_view key, std::int32_t partition,
+                               void* opaque, std::string& error) override;
+    void poll(int timeoutMs) override;
+    bool flush(int timeoutMs) override;
+
+    // Counters so far
+    MockKafkaStats getStats() const;
+
+    // Delivery reports whose payload changed between produce and report
+    std::uint64_t getCorruptPayloads() const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Message {
+        std::string_view payload;
+        std::uint64_t checksum; // Of the payload at produce time, if verifying
+        void* opaque;
+        Clock::time_point due;  // When the delivery report is ready
+        bool fail;
+    };
+
+    MockKafkaConfig config_;
+    KafkaDeliveryListener* listener_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable changed_;
+    std::deque<Message> queue_;   // In produce order, with non-decreasing due times
+    size_t reporting_;            // Messages taken off the queue whose report is running
+    Clock::time_point linkFree_;  // When the link finishes sending what is queued
+    Clock::time_point lastDue_;
+    std::mt19937 rng_;
+    MockKafkaStats stats_;
+    std::uint64_t corruptPayloads_;
+
+    // Serve the reports due by now; returns how many were served
+    size_t deliverDue();
+};
+
+#endif // VEHICLE_SIM_MOCK_KAFKA_BACKEND_H
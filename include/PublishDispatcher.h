@@ -0,0 +1,125 @@
+#ifndef VEHICLE_SIM_PUBLISH_DISPATCHER_H
+#define VEHICLE_SIM_PUBLISH_DISPATCHER_H
+
+#include "Publisher.h"
+#include "VehicleSerializer.h"
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// What a sink's queue does when the sink falls behind
+enum class BackpressurePolicy {
+    Block,      // Wait for space; the simulation slows to the sink's pace
+    DropOldest, // Evict the oldest queued tick to make room for the newest
+    Sample      // Past half full, admit only every sampleEvery-th tick; drop when full
+};
+
+// Per-sink queueing settings
+struct SinkPolicy {
+    BackpressurePolicy backpressure = BackpressurePolicy::Block;
+    size_t queueDepth = 64;  // Ticks the sink may fall behind
+    size_t sampleEvery = 10; // Sampling stride under pressure (Sample only)
+};
+
+// Per-sink counters
+struct SinkStats {
+    std::string name;
+    std::uint64_t ticksOffered = 0;   // Ticks handed to the dispatcher
+    std::uint64_t ticksQueued = 0;    // Ticks admitted to the queue
+    std::uint64_t ticksPublished = 0; // Ticks handed to the sink
+    std::uint64_t ticksDropped = 0;   // Ticks not admitted or evicted before publishing
+    std::uint64_t recordsPublished = 0;
+    double blockedSeconds = 0.0;      // Time the publishing thread waited (Block only)
+    size_t highWaterMark = 0;         // Deepest the queue has been
+    size_t queueDepth = 0;            // Ticks waiting in the queue now
+};
+
+// Fans each tick out to any number of sinks.
+//
+// Every tick is copied once and encoded once per format some sink reads,
+// then the same immutable batch is queued to every sink; adding a sink
+// that reads an existing format costs a queue push, not another
+// serialization pass. Each sink has its own thread and bounded queue, and
+// its policy decides what happens when that queue fills up, so a slow sink
+// only affects its own output (unless it asks to block).
+//
+// Sinks are not owned and must outlive the dispatcher. Records reference
+// vehicle ids owned by the simulation's FleetStore, so the dispatcher must
+// also be destroyed before the simulation it is fed from.
+class PublishDispatcher {
+public:
+    // Told about every tick a sink drops, with the sink's name and the tick's records
+    using DropCallback = std::function<void(const std::string& sink, const TickInfo& info,
+                                            const std::vector<VehicleRecord>& records)>;
+
+    PublishDispatcher() = default;
+
+    // Destructor drains every queue and joins the sink threads
+    ~PublishDispatcher();
+
+    PublishDispatcher(const PublishDispatcher&) = delete;
+    PublishDispatcher& operator=(const PublishDispatcher&) = delete;
+
+    // Add a sink and start its thread; add all sinks before the first tick
+    void addSink(const std::string& name, Publisher& sink, const SinkPolicy& policy = SinkPolicy());
+
+    // Report dropped ticks; called on the thread calling publishTick()
+    void setDropCallback(DropCallback callback) { dropCallback_ = std::move(callback); }
+
+    // Encode a tick and queue it to every sink
+    void publishTick(const TickSnapshot& snapshot);
+
+    // Wait until every queued tick has been published, then flush the sinks
+    void flush();
+
+    // Counters so far, in the order the sinks were added
+    std::vector<SinkStats> getStats() const;
+
+    size_t getSinkCount() const { return sinks_.size(); }
+
+private:
+    // One encoded tick, shared read-only by every sink queue
+    struct Batch {
+        TickInfo info;
+        std::vector<VehicleRecord> records;
+        std::string json;
+        std::vector<std::uint32_t> jsonOffsets;
+    };
+
+    struct Sink {
+        std::string name;
+        Publisher* publisher;
+        SinkPolicy policy;
+
+        std::mutex mutex;
+        std::condition_variable workAvailable; // Queue gained a tick or stopping
+        std::condition_variable spaceAvailable; // Queue lost a tick or went idle
+        std::deque<std::shared_ptr<const Batch>> queue;
+        bool busy = false;     // Sink thread is inside publish()
+        bool stopping = false;
+        SinkStats stats;
+
+        std::thread worker;
+    };
+
+    std::vector<std::unique_ptr<Sink>> sinks_;
+    bool needsJson_ = false;
+    VehicleJsonSerializer serializer_;
+    size_t lastJsonSize_ = 0; // Reserve hint for the next tick
+    DropCallback dropCallback_;
+
+    // Queue a batch to one sink according to its policy; returns the batch
+    // the policy dropped (the new or the oldest one), if any
+    std::shared_ptr<const Batch> enqueue(Sink& sink, const std::shared_ptr<const Batch>& batch);
+
+    // Sink thread main loop
+    static void drainLoop(Sink& sink);
+};
+
+#endif // VEHICLE_SIM_PUBLISH_DISPATCHER_H
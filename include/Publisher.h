@@ -0,0 +1,47 @@
+#ifndef VEHICLE_SIM_PUBLISHER_H
+#define VEHICLE_SIM_PUBLISHER_H
+
+#include "TickSnapshot.h"
+#include <cstdint>
+#include <string_view>
+
+// Encoding a sink reads from a batch; each is built at most once per tick
+enum class PayloadFormat {
+    Records, // Raw records only; the sink encodes them itself
+    Json     // Compact JSON per record, as VehicleJsonSerializer::append
+};
+
+// One tick of records with the encodings shared by every sink.
+// Only valid for the duration of Publisher::publish.
+struct PublishBatch {
+    TickInfo info;
+    const VehicleRecord* records;
+    size_t count;
+
+    // JSON of all records back to back; record i spans
+    // [jsonOffsets[i], jsonOffsets[i + 1]). Empty unless a sink reads Json.
+    std::string_view json;
+    const std::uint32_t* jsonOffsets;
+
+    // JSON of one record
+    std::string_view jsonAt(size_t index) const {
+        return json.substr(jsonOffsets[index], jsonOffsets[index + 1] - jsonOffsets[index]);
+    }
+};
+
+// Interface of an output sink fed by a PublishDispatcher
+class Publisher {
+public:
+    virtual ~Publisher() = default;
+
+    // Encoding this sink reads from batches
+    virtual PayloadFormat getPayloadFormat() const { return PayloadFormat::Records; }
+
+    // Publish one batch; called from a single thread at a time
+    virtual bool publish(const PublishBatch& batch) = 0;
+
+    // Push buffered output to its destination
+    virtual bool flush() { return true; }
+};
+
+#endif // VEHICLE_SIM_PUBLISHER_H
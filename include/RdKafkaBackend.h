@@ -0,0 +1,54 @@
+#ifndef VEHICLE_SIM_RDKAFKA_BACKEND_H
+#define VEHICLE_SIM_RDKAFKA_BACKEND_H
+
+#include "KafkaBackend.h"
+#include <memory>
+#include <string>
+#include <librdkafka/rdkafkacpp.h>
+
+// Producer backend talking to real brokers through librdkafka
+class RdKafkaBackend : public KafkaProducerBackend {
+public:
+    // Constructor with Kafka broker address, topic name and producer settings
+    RdKafkaBackend(const std::string& brokerAddress, const std::string& topicName, const KafkaConfig& config);
+
+    // Destructor releases the topic before the producer
+    ~RdKafkaBackend() override;
+
+    RdKafkaBackend(const RdKafkaBackend&) = delete;
+    RdKafkaBackend& operator=(const RdKafkaBackend&) = delete;
+
+    bool isReady() const override { return producer_ && topic_; }
+    void setDeliveryListener(KafkaDeliveryListener* listener) override { deliveryReporter_.listener = listener; }
+    KafkaProduceStatus produce(std::string_view payload, std::string_view key, std::int32_t partition,
+                               void* opaque, std::string& error) override;
+    void poll(int timeoutMs) override;
+    bool flush(int timeoutMs) override;
+
+private:
+    // Forwards librdkafka delivery reports to the listener
+    class DeliveryReporter : public RdKafka::DeliveryReportCb {
+    public:
+        KafkaDeliveryListener* listener = nullptr;
+        void dr_cb(RdKafka::Message& message) override;
+    };
+
+    std::string brokerAddress_;
+    std::string topicName_;
+
+    DeliveryReporter deliveryReporter_;
+
+    // Kafka producer configuration
+    std::unique_ptr<RdKafka::Conf> conf_;
+
+    // Kafka producer instance
+    std::unique_ptr<RdKafka::Producer> producer_;
+
+    // Kafka topic handle
+    std::unique_ptr<RdKafka::Topic> topic_;
+
+    // Set one producer property, reporting failures
+    bool setProperty(const std::string& name, const std::string& value);
+};
+
+#endif // VEHICLE_SIM_RDKAFKA_BACKEND_H
@@ -0,0 +1,117 @@
+#ifndef VEHICLE_SIM_RING_BUFFER_H
+#define VEHICLE_SIM_RING_BUFFER_H
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+
+// Bounded lock-free queue of fixed-size records.
+//
+// Every cell carries a sequence number that tells producers and consumers
+// whose turn it is (Vyukov's bounded MPMC design): a producer claims the
+// cell at the enqueue position with one compare-exchange, copies the record
+// in and publishes it by bumping the cell's sequence; consumers do the
+// mirror image. Neither side ever waits for the other, so any number of
+// producers and consumers can share a queue, and the single-producer or
+// single-consumer cases pay only for an uncontended compare-exchange.
+// A full queue rejects the push instead of blocking.
+template <typename T>
+class RingBuffer {
+    static_assert(std::is_trivially_copyable<T>::value, "RingBuffer records must be trivially copyable");
+
+public:
+    // Constructor with the minimum capacity; rounded up to a power of two
+    explicit RingBuffer(size_t capacity) {
+        size_t size = 2;
+        while (size < capacity) {
+            size <<= 1;
+        }
+        mask_ = size - 1;
+        cells_.reset(new Cell[size]);
+        for (size_t i = 0; i < size; ++i) {
+            cells_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+        enqueuePos_.store(0, std::memory_order_relaxed);
+        dequeuePos_.store(0, std::memory_order_relaxed);
+    }
+
+    RingBuffer(const RingBuffer&) = delete;
+    RingBuffer& operator=(const RingBuffer&) = delete;
+
+    // Append a record; returns false if the queue is full
+    bool tryPush(const T& value) {
+        size_t pos = enqueuePos_.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell& cell = cells_[pos & mask_];
+            size_t sequence = cell.sequence.load(std::memory_order_acquire);
+            auto diff = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(pos);
+            if (diff == 0) {
+                if (enqueuePos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    cell.value = value;
+                    cell.sequence.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false; // Cell still holds an unconsumed record
+            } else {
+                pos = enqueuePos_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // Remove the oldest record; returns false if the queue is empty
+    bool tryPop(T& value) {
+        size_t pos = dequeuePos_.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell& cell = cells_[pos & mask_];
+            size_t sequence = cell.sequence.load(std::memory_order_acquire);
+            auto diff = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(pos + 1);
+            if (diff == 0) {
+                if (dequeuePos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    value = cell.value;
+                    cell.sequence.store(pos + mask_ + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false; // Cell not written yet
+            } else {
+                pos = dequeuePos_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // Remove up to maxCount records into out; returns the number removed
+    size_t popBatch(T* out, size_t maxCount) {
+        size_t count = 0;
+        while (count < maxCount && tryPop(out[count])) {
+            ++count;
+        }
+        return count;
+    }
+
+    // Approximate number of queued records (exact when both sides are idle)
+    size_t size() const {
+        size_t enqueued = enqueuePos_.load(std::memory_order_acquire);
+        size_t dequeued = dequeuePos_.load(std::memory_order_acquire);
+        return enqueued > dequeued ? enqueued - dequeued : 0;
+    }
+
+    bool empty() const { return size() == 0; }
+    size_t capacity() const { return mask_ + 1; }
+
+private:
+    struct Cell {
+        std::atomic<size_t> sequence;
+        T value;
+    };
+
+    std::unique_ptr<Cell[]> cells_;
+    size_t mask_;
+
+    // Producer and consumer positions on separate cache lines
+    alignas(64) std::atomic<size_t> enqueuePos_;
+    alignas(64) std::atomic<size_t> dequeuePos_;
+};
+
+#endif // VEHICLE_SIM_RING_BUFFER_H
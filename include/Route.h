@@ -1,81 +1,283 @@
 #ifndef VEHICLE_SIM_ROUTE_H
 #define VEHICLE_SIM_ROUTE_H
 
+#include "LocalProjection.h"
 #include <vector>
+#include <atomic>
 #include <cmath>
+#include <cstdint>
+#include <memory>
+#include <mutex>
 #include <utility>
 
-// Represents a 2D position with latitude and longitude
-struct GeoPoint {
-    double lat;  // Latitude
-    double lon;  // Longitude
+// Precomputed data for the segment from one waypoint to the next
+struct RouteSegment {
+    double dx;     // East delta to the next waypoint in metres
+    double dy;     // North delta to the next waypoint in metres
+    double length; // Segment length in metres
+};
+
+// Closest point on a route to a query position
+struct RouteSnap {
+    LocalPoint point; // Closest point on the route
+    double distance;  // Distance from the query position to point, in metres
+    size_t segment;   // Segment the point lies on (0 for single-waypoint routes)
+    double fraction;  // Position along that segment in [0, 1]
+};
+
+// Uniform grid over the route's segment bounding boxes, in compressed
+// row form: the segments overlapping cell c are
+// cellSegments[cellStart[c] .. cellStart[c + 1]).
+struct SegmentGrid {
+    double minX;
+    double minY;
+    double cellSize;
+    size_t rows;
+    size_t cols;
+    std::vector<std::uint32_t> cellStart;
+    std::vector<std::uint32_t> cellSegments;
+};
+
+// Per-vehicle progress along a route
+struct RouteCursor {
+    std::uint32_t waypointIndex = 0; // Waypoint the vehicle is heading for
+};
+
+// Waypoints of a route plus precomputed segment data.
+// Shared between every vehicle driving the route and immutable once shared.
+//
+// Waypoints are projected once onto a local tangent plane and all geometry
+// (segments, distances, the closest-point grid) is in metres on that plane.
+// Without an explicit projection the plane is centred on the first waypoint.
+// The segment grid for closest-point queries is built on first use.
+class RouteGeometry {
+public:
+    // Constructor with waypoints, projected around the first waypoint
+    explicit RouteGeometry(const std::vector<GeoPoint>& waypoints = {})
+            : hasProjection_(false), index_(nullptr) {
+        appendAll(waypoints);
+    }
+
+    // Constructor with waypoints and the projection to use
+    RouteGeometry(const std::vector<GeoPoint>& waypoints, const LocalProjection& projection)
+            : projection_(projection), hasProjection_(true), index_(nullptr) {
+        appendAll(waypoints);
+    }
+
+    RouteGeometry(const RouteGeometry&) = delete;
+    RouteGeometry& operator=(const RouteGeometry&) = delete;
+
+    // Append a waypoint; only valid while the geometry is not shared
+    void append(const GeoPoint& waypoint) {
+        if (!hasProjection_) {
+            projection_ = LocalProjection(waypoint);
+            hasProjection_ = true;
+        }
+
+        LocalPoint point = projection_.toLocal(waypoint);
+        if (points_.empty()) {
+            cumulativeDistance_.push_back(0.0);
+        } else {
+            const LocalPoint& last = points_.back();
+            double length = last.distanceTo(point);
+            segments_.push_back({point.x - last.x, point.y - last.y, length});
+            cumulativeDistance_.push_back(cumulativeDistance_.back() + length);
+        }
+        waypoints_.push_back(waypoint);
+        points_.push_back(point);
+
+        // Any existing index no longer covers the new segment
+        grid_.reset();
+        index_.store(nullptr, std::memory_order_release);
+    }
+
+    // Closest point on the route to a position; sublinear in the number of
+    // segments for long routes. Returns an infinite distance for empty routes,
+    // and the first waypoint at a non-finite distance for non-finite positions.
+    RouteSnap closestPoint(const LocalPoint& position) const;
+
+    // Sum of all segment lengths in metres
+    double getTotalDistance() const {
+        return cumulativeDistance_.empty() ? 0.0 : cumulativeDistance_.back();
+    }
+
+    // Distance along the route from the first waypoint to the given one
+    double distanceToWaypoint(size_t index) const { return cumulativeDistance_[index]; }
+
+    // Distance along the route from the first waypoint to a snapped point
+    double distanceAlongRoute(const RouteSnap& snap) const {
+        if (segments_.empty()) {
+            return 0.0;
+        }
+        return cumulativeDistance_[snap.segment] + snap.fraction * segments_[snap.segment].length;
+    }
+
+    // Point at the given distance along the route, clamped to its ends (O(log n))
+    LocalPoint pointAtDistance(double distance) const;
+
+    // Distance still to drive from a position: straight to the cursor's
+    // waypoint, then along the route to its end (O(1))
+    double remainingDistance(const RouteCursor& cursor, const LocalPoint& position) const {
+        if (points_.empty()) {
+            return 0.0;
+        }
+        return position.distanceTo(points_[cursor.waypointIndex])
+               + getTotalDistance() - cumulativeDistance_[cursor.waypointIndex];
+    }
+
+    // Waypoint the cursor is heading for
+    GeoPoint currentWaypoint(const RouteCursor& cursor) const {
+        if (waypoints_.empty()) {
+            return {0.0, 0.0}; // Default point if no waypoints
+        }
+        return waypoints_[cursor.waypointIndex];
+    }
 
-    // Distance calculation between two GeoPoints (simple Euclidean for now)
-    double distanceTo(const GeoPoint& other) const {
-        // Note: A proper implementation would use Haversine formula
-        // This is simplified for initial implementation
-        return std::sqrt(std::pow(lat - other.lat, 2) + std::pow(lon - other.lon, 2));
+    // Waypoint the cursor is heading for, on the local plane
+    LocalPoint currentLocalWaypoint(const RouteCursor& cursor) const {
+        if (points_.empty()) {
+            return projection_.toLocal({0.0, 0.0}); // Default point if no waypoints
+        }
+        return points_[cursor.waypointIndex];
+    }
+
+    // Waypoint after the cursor's current one
+    GeoPoint nextWaypoint(const RouteCursor& cursor) const {
+        if (waypoints_.empty() || cursor.waypointIndex + 1 >= waypoints_.size()) {
+            return currentWaypoint(cursor); // Return current if no next exists
+        }
+        return waypoints_[cursor.waypointIndex + 1];
+    }
+
+    // Move the cursor to the next waypoint; returns false if the route is completed
+    bool advance(RouteCursor& cursor) const {
+        if (cursor.waypointIndex + 1 < waypoints_.size()) {
+            cursor.waypointIndex++;
+            return true;
+        }
+        return false;
+    }
+
+    // Check if the cursor has completed the route
+    bool isCompleted(const RouteCursor& cursor) const {
+        return !waypoints_.empty() && cursor.waypointIndex + 1 >= waypoints_.size();
+    }
+
+    // Getters
+    const std::vector<GeoPoint>& getWaypoints() const { return waypoints_; }
+    const std::vector<LocalPoint>& getLocalWaypoints() const { return points_; }
+    const std::vector<RouteSegment>& getSegments() const { return segments_; }
+    const LocalProjection& getProjection() const { return projection_; }
+    size_t size() const { return waypoints_.size(); }
+    bool empty() const { return waypoints_.empty(); }
+
+private:
+    std::vector<GeoPoint> waypoints_;
+    std::vector<LocalPoint> points_;     // Waypoints on the local plane
+    std::vector<RouteSegment> segments_; // segments_[i] runs from waypoint i to i + 1
+    std::vector<double> cumulativeDistance_; // Route distance up to each waypoint
+    LocalProjection projection_;
+    bool hasProjection_;
+
+    // Lazily built segment grid; index_ publishes grid_ once it is complete
+    mutable std::mutex gridMutex_;
+    mutable std::unique_ptr<SegmentGrid> grid_;
+    mutable std::atomic<const SegmentGrid*> index_;
+
+    // Append a list of waypoints
+    void appendAll(const std::vector<GeoPoint>& waypoints) {
+        waypoints_.reserve(waypoints.size());
+        points_.reserve(waypoints.size());
+        cumulativeDistance_.reserve(waypoints.size());
+        for (const GeoPoint& waypoint : waypoints) {
+            append(waypoint);
+        }
     }
+
+    // Get the segment grid, building it on first use
+    const SegmentGrid& segmentGrid() const;
+
+    // Closest point on one segment
+    RouteSnap snapToSegment(const LocalPoint& position, size_t segment) const;
 };
 
-// Represents a route as a series of waypoints
+// Represents a route as a series of waypoints: shared geometry plus this route's cursor.
+// Copying a Route shares the geometry; adding waypoints to a shared geometry copies it first.
+// Distances are in metres.
 class Route {
 public:
     // Constructor with initial waypoints
-    Route(const std::vector<GeoPoint>& waypoints) : waypoints_(waypoints), currentWaypointIndex_(0) {}
+    Route(const std::vector<GeoPoint>& waypoints) : geometry_(std::make_shared<RouteGeometry>(waypoints)) {}
 
     // Default constructor
-    Route() : currentWaypointIndex_(0) {}
+    Route() : geometry_(std::make_shared<RouteGeometry>()) {}
+
+    // Constructor with existing geometry and cursor
+    Route(std::shared_ptr<const RouteGeometry> geometry, RouteCursor cursor)
+            : geometry_(std::move(geometry)), cursor_(cursor) {}
 
     // Add a waypoint to the route
     void addWaypoint(const GeoPoint& waypoint) {
-        waypoints_.push_back(waypoint);
+        if (geometry_.use_count() != 1) {
+            geometry_ = geometry_->empty()
+                        ? std::make_shared<RouteGeometry>()
+                        : std::make_shared<RouteGeometry>(geometry_->getWaypoints(), geometry_->getProjection());
+        }
+        // Sole owner, so the geometry is not visible to anyone else yet
+        std::const_pointer_cast<RouteGeometry>(geometry_)->append(waypoint);
     }
 
     // Get current waypoint
     GeoPoint getCurrentWaypoint() const {
-        if (waypoints_.empty()) {
-            return {0.0, 0.0}; // Default point if no waypoints
-        }
-        return waypoints_[currentWaypointIndex_];
+        return geometry_->currentWaypoint(cursor_);
     }
 
     // Get next waypoint
     GeoPoint getNextWaypoint() const {
-        if (waypoints_.empty() || currentWaypointIndex_ >= waypoints_.size() - 1) {
-            return getCurrentWaypoint(); // Return current if no next exists
-        }
-        return waypoints_[currentWaypointIndex_ + 1];
+        return geometry_->nextWaypoint(cursor_);
     }
 
     // Advance to next waypoint
     bool advanceToNextWaypoint() {
-        if (currentWaypointIndex_ < waypoints_.size() - 1) {
-            currentWaypointIndex_++;
-            return true;
-        }
-        return false; // Route completed
+        return geometry_->advance(cursor_);
     }
 
     // Check if route is completed
     bool isCompleted() const {
-        return !waypoints_.empty() && currentWaypointIndex_ >= waypoints_.size() - 1;
+        return geometry_->isCompleted(cursor_);
     }
 
-    // Get closest point on the route to a given position
+    // Get closest point on the route to a given position, with its distance from the position
     std::pair<GeoPoint, double> getClosestPointOnRoute(const GeoPoint& position) const;
 
+    // Snap many positions onto the route in one call
+    std::vector<std::pair<GeoPoint, double>> getClosestPointOnRoute(const std::vector<GeoPoint>& positions) const;
+
     // Get total route distance
     double getTotalDistance() const;
 
+    // Get the point at a distance along the route
+    GeoPoint pointAtDistance(double distance) const {
+        return geometry_->getProjection().toGeo(geometry_->pointAtDistance(distance));
+    }
+
+    // Get the distance left to drive from a position, following this route's cursor
+    double remainingDistance(const GeoPoint& position) const {
+        return geometry_->remainingDistance(cursor_, geometry_->getProjection().toLocal(position));
+    }
+
     // Get all waypoints
     const std::vector<GeoPoint>& getWaypoints() const {
-        return waypoints_;
+        return geometry_->getWaypoints();
     }
 
+    // Shared geometry and this route's cursor
+    const std::shared_ptr<const RouteGeometry>& getGeometry() const { return geometry_; }
+    RouteCursor getCursor() const { return cursor_; }
+
 private:
-    std::vector<GeoPoint> waypoints_;
-    size_t currentWaypointIndex_;
+    std::shared_ptr<const RouteGeometry> geometry_;
+    RouteCursor cursor_;
 };
 
-#endif // VEHICLE_SIM_ROUTE_H
\ No newline at end of file
+#endif // VEHICLE_SIM_ROUTE_H
@@ -1,10 +1,19 @@
 #ifndef VEHICLE_SIM_SIMULATION_H
 #define VEHICLE_SIM_SIMULATION_H
 
+#include "DynamicsKernel.h"
+#include "FleetStore.h"
+#include "SimulationClock.h"
+#include "SnapshotPipeline.h"
+#include "ThreadPool.h"
+#include "TickSnapshot.h"
 #include "Vehicle.h"
+#include <algorithm>
 #include <vector>
 #include <memory>
 #include <chrono>
+#include <cstdint>
+#include <ctime>
 #include <functional>
 
 // Callback type for vehicle updates
@@ -17,18 +26,102 @@ public:
     Simulation(double timeStep = 0.1) 
         : timeStep_(timeStep), 
           running_(false),
-          simulationTime_(0.0) {}
+          simulationTime_(0.0),
+          tick_(0),
+          parallelChunkSize_(4096),
+          validateKernel_(false) {}
+
+    // Callbacks capture the simulation, so it must stay in place
+    Simulation(const Simulation&) = delete;
+    Simulation& operator=(const Simulation&) = delete;
     
-    // Add a vehicle to the simulation
-    void addVehicle(std::shared_ptr<Vehicle> vehicle) {
-        vehicles_.push_back(vehicle);
+    // Add a vehicle to the simulation and return a view of it
+    Vehicle addVehicle(const std::string& id, const GeoPoint& position, const Route& route) {
+        return Vehicle(&fleet_, fleet_.add(id, position, route));
+    }
+
+    // Remove a vehicle from the simulation; Vehicle views of it become stale (see Vehicle::isValid)
+    bool removeVehicle(VehicleHandle handle) {
+        return fleet_.remove(handle);
+    }
+
+    // Reserve storage for the expected fleet size
+    void reserveVehicles(size_t count) {
+        fleet_.reserve(count);
     }
     
-    // Register callback for vehicle updates
+    // Register callback for vehicle updates, called once per vehicle per tick.
+    // Implemented on top of the tick snapshot; since the callback sees a live
+    // view of the vehicle it always runs on the simulation thread.
     void registerVehicleUpdateCallback(VehicleUpdateCallback callback) {
-        vehicleUpdateCallbacks_.push_back(callback);
+        vehicleUpdateCallbacks_.push_back([this, callback](const TickSnapshot& snapshot) {
+            for (const VehicleState& state : snapshot) {
+                callback(Vehicle(&fleet_, state.handle));
+            }
+        });
+    }
+
+    // Register callback for whole-tick updates, called once per tick.
+    // With pipelined publishing this runs on the publishing thread.
+    void registerTickCallback(TickCallback callback) {
+        if (pipeline_) {
+            pipeline_->addConsumer(std::move(callback));
+        } else {
+            tickCallbacks_.push_back(std::move(callback));
+        }
+    }
+
+    // Run tick callbacks on a separate thread from double-buffered snapshots,
+    // so publishing tick N overlaps with simulating tick N+1. Call before
+    // registering tick callbacks.
+    void enablePipelinedPublishing(LagPolicy policy) {
+        pipeline_ = std::make_unique<SnapshotPipeline>(policy);
+        for (auto& callback : tickCallbacks_) {
+            pipeline_->addConsumer(std::move(callback));
+        }
+        tickCallbacks_.clear();
+    }
+
+    // Wait until pipelined tick callbacks have caught up with the simulation
+    void waitForPublishing() {
+        if (pipeline_) {
+            pipeline_->waitIdle();
+        }
     }
     
+    // Set the number of threads used for the vehicle update; 0 or 1 runs serially
+    void setThreadCount(size_t threadCount) {
+        if (threadCount > 1) {
+            pool_ = std::make_unique<ThreadPool>(threadCount);
+        } else {
+            pool_.reset();
+        }
+    }
+
+    // Set the number of vehicles per parallel work chunk; rounded up to a
+    // multiple of the dynamics kernel's width when used
+    void setParallelChunkSize(size_t chunkSize) {
+        parallelChunkSize_ = chunkSize;
+    }
+
+    // Select the dynamics kernel; unsupported instruction sets fall back to the best available
+    void setKernelIsa(KernelIsa isa) {
+        fleet_.setKernelIsa(isa);
+    }
+
+    // Set the local projection vehicles are simulated on; must be called before
+    // adding vehicles (by default it is centred on the first vehicle's route).
+    // Returns false, leaving the projection unchanged, once vehicles exist
+    bool setProjection(const GeoPoint& origin) {
+        return fleet_.setProjection(LocalProjection(origin));
+    }
+
+    // Diff the selected kernel against the scalar path on every tick
+    void setKernelValidation(bool enabled) {
+        validateKernel_ = enabled;
+        kernelValidationReport_ = KernelDiff();
+    }
+
     // Start simulation
     void start() {
         running_ = true;
@@ -42,24 +135,53 @@ public:
     // Reset simulation
     void reset() {
         simulationTime_ = 0.0;
+        tick_ = 0;
     }
     
     // Update simulation by one time step
     void update() {
         if (!running_) return;
         
-        // Update all vehicles
-        for (auto& vehicle : vehicles_) {
-            vehicle->update(timeStep_);
-            
-            // Notify callbacks
-            for (const auto& callback : vehicleUpdateCallbacks_) {
-                callback(*vehicle);
-            }
+        // Compare the batched kernel against the scalar path before stepping
+        if (validateKernel_ && fleet_.getKernelIsa() != KernelIsa::Scalar) {
+            recordKernelValidation(compareKernels(fleet_.getKernelIsa(), fleet_.kernelView(),
+                                                  0, fleet_.size(), timeStep_));
         }
-        
+
+        // Update all vehicles; slots are independent, and chunks start on
+        // multiples of the kernel width, so every slot takes the same vector
+        // or scalar-tail path as in the serial update and the parallel path
+        // produces exactly the same state
+        if (pool_) {
+            size_t width = kernelIsaWidth(fleet_.getKernelIsa());
+            size_t chunkSize = (std::max<size_t>(parallelChunkSize_, 1) + width - 1) / width * width;
+            pool_->parallelFor(fleet_.size(), chunkSize, [this](size_t begin, size_t end) {
+                fleet_.updateRange(begin, end, timeStep_);
+            });
+        } else {
+            fleet_.updateRange(0, fleet_.size(), timeStep_);
+        }
+
         // Update simulation time
         simulationTime_ += timeStep_;
+        ++tick_;
+
+        // Notify callbacks with one snapshot of the whole tick
+        if (pipeline_) {
+            TickSnapshot snapshot = takeSnapshot(pipeline_->backBuffer());
+            for (const auto& callback : vehicleUpdateCallbacks_) {
+                callback(snapshot);
+            }
+            pipeline_->publish(snapshot.info);
+        } else if (!tickCallbacks_.empty() || !vehicleUpdateCallbacks_.empty()) {
+            TickSnapshot snapshot = takeSnapshot(states_);
+            for (const auto& callback : vehicleUpdateCallbacks_) {
+                callback(snapshot);
+            }
+            for (const auto& callback : tickCallbacks_) {
+                callback(snapshot);
+            }
+        }
     }
     
     // Run simulation for specified duration
@@ -69,12 +191,31 @@ public:
             update();
         }
     }
+
+    // Run simulation for specified duration, paced by the given clock
+    void runFor(double duration, SimulationClock& clock) {
+        double endTime = simulationTime_ + duration;
+        while (running_ && simulationTime_ < endTime) {
+            clock.beginTick();
+            update();
+            clock.endTick();
+        }
+    }
     
     // Getters
     double getTimeStep() const { return timeStep_; }
     double getSimulationTime() const { return simulationTime_; }
+    std::uint64_t getTick() const { return tick_; }
     bool isRunning() const { return running_; }
-    const std::vector<std::shared_ptr<Vehicle>>& getVehicles() const { return vehicles_; }
+    size_t getThreadCount() const { return pool_ ? pool_->getThreadCount() : 1; }
+    KernelIsa getKernelIsa() const { return fleet_.getKernelIsa(); }
+    bool isPublishingPipelined() const { return pipeline_ != nullptr; }
+    PipelineStats getPipelineStats() const { return pipeline_ ? pipeline_->getStats() : PipelineStats(); }
+    const KernelDiff& getKernelValidationReport() const { return kernelValidationReport_; }
+    size_t getVehicleCount() const { return fleet_.size(); }
+    Vehicle getVehicle(VehicleHandle handle) { return Vehicle(&fleet_, handle); }
+    const FleetStore& getFleet() const { return fleet_; }
+    const LocalProjection& getProjection() const { return fleet_.getProjection(); }
     
     // Setters
     void setTimeStep(double timeStep) { timeStep_ = timeStep; }
@@ -83,8 +224,37 @@ private:
     double timeStep_;      // Time step in seconds
     bool running_;         // Simulation running state
     double simulationTime_;// Current simulation time
-    std::vector<std::shared_ptr<Vehicle>> vehicles_;
-    std::vector<VehicleUpdateCallback> vehicleUpdateCallbacks_;
+    std::uint64_t tick_;   // Number of completed ticks
+    FleetStore fleet_;
+    std::unique_ptr<ThreadPool> pool_; // Null when updating serially
+    size_t parallelChunkSize_;         // Vehicles per parallel work chunk
+    bool validateKernel_;              // Diff batched kernel against scalar each tick
+    KernelDiff kernelValidationReport_;// Worst divergence seen since validation was enabled
+
+    // Copy the fleet into a snapshot buffer
+    TickSnapshot takeSnapshot(std::vector<VehicleState>& states) {
+        size_t count = fleet_.size();
+        states.resize(count);
+        for (size_t slot = 0; slot < count; ++slot) {
+            states[slot] = {fleet_.handleAt(slot), fleet_.idAt(slot), fleet_.positionAt(slot),
+                            fleet_.headingAt(slot), fleet_.speedAt(slot)};
+        }
+        return {{tick_, simulationTime_, timeStep_, std::time(nullptr)}, states.data(), count};
+    }
+
+    // Fold one tick's kernel comparison into the running report
+    void recordKernelValidation(const KernelDiff& diff) {
+        KernelDiff& report = kernelValidationReport_;
+        report.maxPositionError = std::max(report.maxPositionError, diff.maxPositionError);
+        report.maxHeadingError = std::max(report.maxHeadingError, diff.maxHeadingError);
+        report.maxSpeedError = std::max(report.maxSpeedError, diff.maxSpeedError);
+        report.waypointMismatches += diff.waypointMismatches;
+        report.vehiclesCompared += diff.vehiclesCompared;
+    }
+    std::vector<TickCallback> vehicleUpdateCallbacks_; // Per-vehicle adapters, always synchronous
+    std::vector<TickCallback> tickCallbacks_;          // Synchronous tick callbacks
+    std::vector<VehicleState> states_;                 // Reused snapshot storage
+    std::unique_ptr<SnapshotPipeline> pipeline_;       // Declared after fleet_ so it drains first
 };
 
 #endif // VEHICLE_SIM_SIMULATION_H
\ No newline at end of file
@@ -0,0 +1,82 @@
+#ifndef VEHICLE_SIM_SIMULATION_CLOCK_H
+#define VEHICLE_SIM_SIMULATION_CLOCK_H
+
+#include <chrono>
+#include <cstdint>
+
+// Tick timing counters
+struct ClockStats {
+    std::uint64_t ticks = 0;          // Ticks paced so far
+    std::uint64_t overruns = 0;       // Ticks that finished after their deadline
+    std::uint64_t resyncs = 0;        // Times the schedule was rebased after falling too far behind
+    double maxOverrunSeconds = 0.0;   // Worst lateness of a tick against its deadline
+    double totalOverrunSeconds = 0.0; // Sum of lateness over all overrunning ticks
+    double maxTickSeconds = 0.0;      // Longest time spent inside one tick
+    double totalTickSeconds = 0.0;    // Time spent inside ticks, excluding waits
+    double wallSeconds = 0.0;         // Wall-clock time since start()
+    double simulationSeconds = 0.0;   // Simulation time covered by the paced ticks
+
+    // Simulated seconds per wall-clock second actually achieved
+    double achievedRealTimeFactor() const {
+        return wallSeconds > 0.0 ? simulationSeconds / wallSeconds : 0.0;
+    }
+};
+
+// Paces simulation ticks against the wall clock.
+//
+// Tick n is due at start + n * timeStep / realTimeFactor. Deadlines are
+// absolute, so sleep overshoot and per-tick work never accumulate into
+// drift: a tick that wakes late simply gets less time before the next
+// deadline. A tick that finishes after its deadline counts as an overrun
+// and the following ticks run back to back until the schedule is met
+// again; if the simulation falls more than the maximum lag behind, the
+// schedule is rebased to now instead of bursting to catch up.
+//
+// A real-time factor of 0 (or below) runs ticks back to back without
+// waiting, while still collecting tick timings.
+class SimulationClock {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    // Constructor with the simulation time step and the real-time factor
+    // (2.0 runs twice as fast as real time)
+    explicit SimulationClock(double timeStep, double realTimeFactor = 1.0);
+
+    // Set the real-time factor; takes effect from the next tick
+    void setRealTimeFactor(double realTimeFactor);
+
+    // Set how far behind schedule the clock may fall before it rebases
+    void setMaxLag(double seconds) { maxLagSeconds_ = seconds; }
+
+    // Anchor the schedule at the current time and reset the counters
+    void start();
+
+    // Mark the start of a tick's work
+    void beginTick();
+
+    // Mark the end of a tick's work and wait until the next tick is due
+    void endTick();
+
+    // Getters
+    double getTimeStep() const { return timeStep_; }
+    double getRealTimeFactor() const { return realTimeFactor_; }
+    bool isThrottled() const { return realTimeFactor_ > 0.0; }
+    ClockStats getStats() const;
+
+private:
+    double timeStep_;       // Simulation seconds per tick
+    double realTimeFactor_; // Simulation seconds per wall second; <= 0 is unthrottled
+    double maxLagSeconds_;  // Lag beyond which the schedule is rebased
+
+    Clock::time_point epoch_;     // Time the current schedule was anchored
+    std::uint64_t epochTick_;     // Ticks paced before the schedule was anchored
+    Clock::time_point started_;   // Time start() was called
+    Clock::time_point tickBegin_; // Start of the current tick's work
+
+    ClockStats stats_;
+
+    // Wall-clock deadline of the given tick
+    Clock::time_point deadline(std::uint64_t tick) const;
+};
+
+#endif // VEHICLE_SIM_SIMULATION_CLOCK_H
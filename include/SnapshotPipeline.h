@@ -0,0 +1,94 @@
+#ifndef VEHICLE_SIM_SNAPSHOT_PIPELINE_H
+#define VEHICLE_SIM_SNAPSHOT_PIPELINE_H
+
+#include "TickSnapshot.h"
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// What the simulation does when consumers fall more than one tick behind
+enum class LagPolicy {
+    Block,   // Wait for the consumers to pick up the pending tick
+    Drop,    // Discard the new tick and keep the pending one
+    Coalesce // Replace the pending tick with the new one
+};
+
+// Pipeline counters
+struct PipelineStats {
+    std::uint64_t ticksPublished = 0; // Ticks handed over by the simulation
+    std::uint64_t ticksDelivered = 0; // Ticks the consumers ran on
+    std::uint64_t ticksDropped = 0;   // New ticks discarded under LagPolicy::Drop
+    std::uint64_t ticksCoalesced = 0; // Pending ticks replaced under LagPolicy::Coalesce
+    double blockedSeconds = 0.0;      // Time the simulation waited under LagPolicy::Block
+};
+
+// Hands tick snapshots from the simulation thread to a consumer thread.
+//
+// Three snapshot buffers rotate between the roles back (being filled by the
+// simulation), pending (complete, not yet picked up) and front (being read
+// by the consumers). Publishing swaps back and pending, and the consumer
+// thread swaps pending and front when it is ready for the next tick; each
+// swap is a pointer exchange under the lock, so neither side ever sees a
+// partially written tick and physics for tick N+1 overlaps with I/O for
+// tick N. If a tick is still pending when the next one is published, the
+// lag policy decides what happens.
+class SnapshotPipeline {
+public:
+    // Constructor with the lag policy; starts the consumer thread
+    explicit SnapshotPipeline(LagPolicy policy);
+
+    // Destructor delivers any pending tick and joins the consumer thread
+    ~SnapshotPipeline();
+
+    SnapshotPipeline(const SnapshotPipeline&) = delete;
+    SnapshotPipeline& operator=(const SnapshotPipeline&) = delete;
+
+    // Register a consumer; consumers run on the pipeline thread in registration
+    // order and must all be registered before the first publish
+    void addConsumer(TickCallback consumer);
+
+    // Buffer for the simulation to fill with the next tick
+    std::vector<VehicleState>& backBuffer() { return buffers_[back_].states; }
+
+    // Hand the back buffer over to the consumers
+    void publish(const TickInfo& info);
+
+    // Wait until every published tick has been consumed or dropped
+    void waitIdle();
+
+    // Counters so far
+    PipelineStats getStats() const;
+
+    LagPolicy getLagPolicy() const { return policy_; }
+
+private:
+    struct Buffer {
+        TickInfo info{};
+        std::vector<VehicleState> states;
+    };
+
+    LagPolicy policy_;
+    std::vector<TickCallback> consumers_;
+
+    Buffer buffers_[3];
+    int back_;         // Owned by the simulation thread
+    int pending_;      // Ready for the consumers
+    int front_;        // Owned by the consumer thread
+    bool hasPending_;  // Pending buffer holds an unconsumed tick
+    bool consuming_;   // Consumer thread is running callbacks
+    bool stopping_;
+
+    PipelineStats stats_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable pendingCondition_; // Signals the consumer thread
+    std::condition_variable consumedCondition_;// Signals blocked publishers and waitIdle
+    std::thread consumer_;
+
+    // Consumer thread main loop
+    void consumeLoop();
+};
+
+#endif // VEHICLE_SIM_SNAPSHOT_PIPELINE_H
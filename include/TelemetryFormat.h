@@ -0,0 +1,149 @@
+#ifndef VEHICLE_SIM_TELEMETRY_FORMAT_H
+#define VEHICLE_SIM_TELEMETRY_FORMAT_H
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+// Binary telemetry file layout, version 1. All integers are little-endian.
+//
+//   header      48 bytes, see TelemetryHeader
+//   records     recordCount * 24 bytes, see TelemetryRecord
+//   dictionary  u32 id count, then per vehicle index: u16 length + UTF-8 id bytes
+//
+// Vehicles are numbered densely in the order the writer first saw them;
+// the dictionary maps those indices back to ids. recordCount and
+// dictionaryOffset are filled in when the writer closes the file, so a file
+// from a writer that did not shut down cleanly has them at zero: its records
+// are still readable (count derived from the file size) but ids are not.
+
+constexpr char TelemetryMagic[8] = {'V', 'S', 'I', 'M', 'T', 'L', 'M', '\0'};
+constexpr std::uint16_t TelemetryVersion = 1;
+constexpr std::size_t TelemetryHeaderSize = 48;
+constexpr std::size_t TelemetryRecordSize = 24;
+
+// Scale of the fixed-point coordinates (1e-7 degrees, about 1 cm)
+constexpr double TelemetryCoordinateScale = 1e7;
+
+// File header
+struct TelemetryHeader {
+    std::uint16_t version = TelemetryVersion;
+    std::uint16_t headerSize = TelemetryHeaderSize;
+    std::uint16_t recordSize = TelemetryRecordSize;
+    std::uint64_t recordCount = 0;      // Written on close
+    std::uint64_t dictionaryOffset = 0; // Written on close; 0 if the file was not closed cleanly
+    double timeStep = 0.0;              // Simulation seconds per tick
+    std::int64_t firstTimestamp = 0;    // Unix time of the first published tick
+};
+
+// One vehicle update
+struct TelemetryRecord {
+    std::uint32_t vehicleIndex; // Index into the id dictionary
+    std::uint32_t tick;
+    double lat;                 // Degrees, stored as int32 * 1e-7
+    double lon;                 // Degrees, stored as int32 * 1e-7
+    float heading;              // Radians
+    float speed;                // m/s
+};
+
+// Little-endian byte packing
+inline void storeLE16(unsigned char* out, std::uint16_t value) {
+    out[0] = static_cast<unsigned char>(value);
+    out[1] = static_cast<unsigned char>(value >> 8);
+}
+
+inline void storeLE32(unsigned char* out, std::uint32_t value) {
+    for (int i = 0; i < 4; ++i) {
+        out[i] = static_cast<unsigned char>(value >> (8 * i));
+    }
+}
+
+inline void storeLE64(unsigned char* out, std::uint64_t value) {
+    for (int i = 0; i < 8; ++i) {
+        out[i] = static_cast<unsigned char>(value >> (8 * i));
+    }
+}
+
+inline std::uint16_t loadLE16(const unsigned char* in) {
+    return static_cast<std::uint16_t>(in[0] | (in[1] << 8));
+}
+
+inline std::uint32_t loadLE32(const unsigned char* in) {
+    return static_cast<std::uint32_t>(in[0]) | (static_cast<std::uint32_t>(in[1]) << 8)
+           | (static_cast<std::uint32_t>(in[2]) << 16) | (static_cast<std::uint32_t>(in[3]) << 24);
+}
+
+inline std::uint64_t loadLE64(const unsigned char* in) {
+    return static_cast<std::uint64_t>(loadLE32(in)) | (static_cast<std::uint64_t>(loadLE32(in + 4)) << 32);
+}
+
+inline std::uint32_t floatBits(float value) {
+    std::uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+inline float bitsToFloat(std::uint32_t bits) {
+    float value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+// Degrees to fixed point, rounded to the nearest step
+inline std::int32_t encodeCoordinate(double degrees) {
+    return static_cast<std::int32_t>(std::lround(degrees * TelemetryCoordinateScale));
+}
+
+// Serialize a header into TelemetryHeaderSize bytes
+inline void encodeTelemetryHeader(unsigned char* out, const TelemetryHeader& header) {
+    std::memset(out, 0, TelemetryHeaderSize);
+    std::memcpy(out, TelemetryMagic, sizeof(TelemetryMagic));
+    storeLE16(out + 8, header.version);
+    storeLE16(out + 10, header.headerSize);
+    storeLE16(out + 12, header.recordSize);
+    // out[14..16) reserved
+    storeLE64(out + 16, header.recordCount);
+    storeLE64(out + 24, header.dictionaryOffset);
+    std::uint64_t timeStepBits;
+    std::memcpy(&timeStepBits, &header.timeStep, sizeof(timeStepBits));
+    storeLE64(out + 32, timeStepBits);
+    storeLE64(out + 40, static_cast<std::uint64_t>(header.firstTimestamp));
+}
+
+// Parse a header; returns false if the magic does not match
+inline bool decodeTelemetryHeader(const unsigned char* in, TelemetryHeader& header) {
+    if (std::memcmp(in, TelemetryMagic, sizeof(TelemetryMagic)) != 0) {
+        return false;
+    }
+    header.version = loadLE16(in + 8);
+    header.headerSize = loadLE16(in + 10);
+    header.recordSize = loadLE16(in + 12);
+    header.recordCount = loadLE64(in + 16);
+    header.dictionaryOffset = loadLE64(in + 24);
+    std::uint64_t timeStepBits = loadLE64(in + 32);
+    std::memcpy(&header.timeStep, &timeStepBits, sizeof(header.timeStep));
+    header.firstTimestamp = static_cast<std::int64_t>(loadLE64(in + 40));
+    return true;
+}
+
+// Serialize a record into TelemetryRecordSize bytes
+inline void encodeTelemetryRecord(unsigned char* out, const TelemetryRecord& record) {
+    storeLE32(out, record.vehicleIndex);
+    storeLE32(out + 4, record.tick);
+    storeLE32(out + 8, static_cast<std::uint32_t>(encodeCoordinate(record.lat)));
+    storeLE32(out + 12, static_cast<std::uint32_t>(encodeCoordinate(record.lon)));
+    storeLE32(out + 16, floatBits(record.heading));
+    storeLE32(out + 20, floatBits(record.speed));
+}
+
+// Parse a record from TelemetryRecordSize bytes
+inline TelemetryRecord decodeTelemetryRecord(const unsigned char* in) {
+    return {loadLE32(in),
+            loadLE32(in + 4),
+            static_cast<std::int32_t>(loadLE32(in + 8)) / TelemetryCoordinateScale,
+            static_cast<std::int32_t>(loadLE32(in + 12)) / TelemetryCoordinateScale,
+            bitsToFloat(loadLE32(in + 16)),
+            bitsToFloat(loadLE32(in + 20))};
+}
+
+#endif // VEHICLE_SIM_TELEMETRY_FORMAT_H
@@ -0,0 +1,106 @@
+#ifndef VEHICLE_SIM_TELEMETRY_READER_H
+#define VEHICLE_SIM_TELEMETRY_READER_H
+
+#include "TelemetryFormat.h"
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Reads a binary telemetry file through a read-only memory mapping.
+//
+// Records are decoded on access straight from the mapped pages, so scanning
+// a file never copies it into user-space buffers. Ids are string views into
+// the mapping and stay valid while the reader is alive. Files from writers
+// that did not close cleanly are readable, but have no ids.
+class TelemetryReader {
+public:
+    // Iterator decoding records in file order
+    class Iterator {
+    public:
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = TelemetryRecord;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void;
+        using reference = TelemetryRecord;
+
+        explicit Iterator(const unsigned char* position) : position_(position) {}
+
+        TelemetryRecord operator*() const { return decodeTelemetryRecord(position_); }
+        Iterator& operator++() { position_ += TelemetryRecordSize; return *this; }
+        Iterator operator++(int) { Iterator previous = *this; ++*this; return previous; }
+        Iterator& operator+=(difference_type n) { position_ += n * static_cast<difference_type>(TelemetryRecordSize); return *this; }
+        Iterator operator+(difference_type n) const { Iterator moved = *this; return moved += n; }
+        difference_type operator-(const Iterator& other) const {
+            return (position_ - other.position_) / static_cast<difference_type>(TelemetryRecordSize);
+        }
+        TelemetryRecord operator[](difference_type n) const { return *(*this + n); }
+        bool operator==(const Iterator& other) const { return position_ == other.position_; }
+        bool operator!=(const Iterator& other) const { return position_ != other.position_; }
+
+    private:
+        const unsigned char* position_;
+    };
+
+    // Constructor with the file to map
+    explicit TelemetryReader(const std::string& path);
+
+    // Destructor unmaps the file
+    ~TelemetryReader();
+
+    TelemetryReader(const TelemetryReader&) = delete;
+    TelemetryReader& operator=(const TelemetryReader&) = delete;
+
+    // File mapped and header valid
+    bool isOpen() const { return data_ != nullptr; }
+
+    // Dictionary and record count were written by a clean close
+    bool isComplete() const { return header_.dictionaryOffset != 0; }
+
+    // Records
+    size_t size() const { return recordCount_; }
+    bool empty() const { return recordCount_ == 0; }
+    TelemetryRecord operator[](size_t index) const { return decodeTelemetryRecord(records_ + index * TelemetryRecordSize); }
+    Iterator begin() const { return Iterator(records_); }
+    Iterator end() const { return Iterator(records_ + recordCount_ * TelemetryRecordSize); }
+
+    // Raw record bytes, for callers that decode fields themselves
+    const unsigned char* recordData() const { return records_; }
+
+    // Id of a vehicle index; empty if unknown
+    std::string_view idOf(std::uint32_t vehicleIndex) const {
+        return vehicleIndex < ids_.size() ? ids_[vehicleIndex] : std::string_view();
+    }
+    size_t getVehicleCount() const { return ids_.size(); }
+
+    // Getters
+    const TelemetryHeader& getHeader() const { return header_; }
+    const std::string& getPath() const { return path_; }
+
+private:
+    std::string path_;
+    const unsigned char* data_; // Start of the mapping
+    size_t fileSize_;
+    const unsigned char* records_;
+    size_t recordCount_;
+    TelemetryHeader header_;
+    std::vector<std::string_view> ids_;
+
+#if defined(_WIN32)
+    void* fileHandle_;
+    void* mappingHandle_;
+#endif
+
+    // Map the file; returns false on failure
+    bool map();
+
+    // Release the mapping
+    void unmap();
+
+    // Parse the id dictionary; returns false if it is malformed
+    bool readDictionary();
+};
+
+#endif // VEHICLE_SIM_TELEMETRY_READER_H
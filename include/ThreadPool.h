@@ -0,0 +1,81 @@
+#ifndef VEHICLE_SIM_THREAD_POOL_H
+#define VEHICLE_SIM_THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fork/join pool for splitting an index range across threads.
+//
+// parallelFor() cuts the range into chunks and deals them out to one deque
+// per thread in contiguous blocks. Each thread works through its own deque
+// from the front and, once empty, steals from the back of the others, so a
+// thread that finishes early picks up the tail of a slower neighbour. The
+// calling thread takes part as thread 0 and parallelFor() only returns
+// once every chunk has run, which makes each call a barrier.
+class ThreadPool {
+public:
+    // Range callback invoked as fn(begin, end)
+    using RangeFunction = std::function<void(size_t, size_t)>;
+
+    // Constructor with the total number of threads, including the caller
+    explicit ThreadPool(size_t threadCount);
+
+    // Destructor joins the worker threads
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Run fn over [0, count) in chunks of at most chunkSize and wait for completion
+    void parallelFor(size_t count, size_t chunkSize, const RangeFunction& fn);
+
+    // Total number of threads, including the caller
+    size_t getThreadCount() const { return queues_.size(); }
+
+private:
+    struct Chunk {
+        size_t begin;
+        size_t end;
+    };
+
+    // Per-thread chunk deque
+    struct WorkQueue {
+        std::mutex mutex;
+        std::deque<Chunk> chunks;
+    };
+
+    std::vector<std::unique_ptr<WorkQueue>> queues_;
+    std::vector<std::thread> workers_;
+
+    // Current job
+    const RangeFunction* job_;
+    std::atomic<size_t> pendingChunks_;
+
+    // Worker wake-up and completion signalling
+    std::mutex mutex_;
+    std::condition_variable wakeCondition_;
+    std::condition_variable doneCondition_;
+    std::uint64_t generation_;
+    bool stopping_;
+
+    // Worker thread main loop
+    void workerLoop(size_t index);
+
+    // Run chunks from the own queue, then steal, until no work is left
+    void runChunks(size_t index);
+
+    // Take a chunk from the front of the own queue
+    bool popLocal(size_t index, Chunk& chunk);
+
+    // Take a chunk from the back of another thread's queue
+    bool steal(size_t index, Chunk& chunk);
+};
+
+#endif // VEHICLE_SIM_THREAD_POOL_H
@@ -0,0 +1,51 @@
+#ifndef VEHICLE_SIM_TICK_SNAPSHOT_H
+#define VEHICLE_SIM_TICK_SNAPSHOT_H
+
+#include "FleetStore.h"
+#include <cstdint>
+#include <ctime>
+#include <functional>
+#include <string_view>
+
+// Immutable state of one vehicle at the end of a tick
+struct VehicleState {
+    VehicleHandle handle;
+    std::string_view id; // Owned by the FleetStore, valid for the store's lifetime
+    GeoPoint position;
+    double heading;      // In radians, 0 = north, increases clockwise
+    double speed;        // In m/s
+};
+
+// One vehicle state tagged with its tick, as a fixed-size record for queues
+struct VehicleRecord {
+    VehicleState state;
+    std::uint64_t tick;    // Tick the state belongs to
+    std::time_t timestamp; // Wall-clock time the tick was published
+};
+
+// Metadata for one simulation tick
+struct TickInfo {
+    std::uint64_t tick;    // Tick number, starting at 1
+    double simulationTime; // Simulation time at the end of the tick
+    double timeStep;       // Time step the tick advanced by
+    std::time_t timestamp; // Wall-clock time the tick was published
+};
+
+// All vehicle states of one tick, in slot order.
+// The states are only valid for the duration of the callback.
+struct TickSnapshot {
+    TickInfo info;
+    const VehicleState* states;
+    size_t count;
+
+    const VehicleState* begin() const { return states; }
+    const VehicleState* end() const { return states + count; }
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    const VehicleState& operator[](size_t index) const { return states[index]; }
+};
+
+// Callback type for whole-tick updates
+using TickCallback = std::function<void(const TickSnapshot&)>;
+
+#endif // VEHICLE_SIM_TICK_SNAPSHOT_H
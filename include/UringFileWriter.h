@@ -0,0 +1,137 @@
+#ifndef VEHICLE_SIM_URING_FILE_WRITER_H
+#define VEHICLE_SIM_URING_FILE_WRITER_H
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// io_uring writer settings
+struct UringWriterConfig {
+    size_t bufferBytes = 1 << 20; // Size of each pooled buffer (rounded to whole blocks)
+    size_t queueDepth = 8;        // Buffers, and so writes, that may be in flight at once
+    bool directIo = false;        // Open with O_DIRECT, bypassing the page cache
+};
+
+// io_uring writer counters
+struct UringWriterStats {
+    std::uint64_t writesSubmitted = 0;
+    std::uint64_t writesCompleted = 0;
+    std::uint64_t writeErrors = 0;
+    std::uint64_t bytesWritten = 0;
+    std::uint64_t bufferWaits = 0;    // Appends that had to wait for a buffer to come back
+    size_t maxInFlight = 0;
+    double averageLatencySeconds = 0.0; // Submission to reaped completion
+    double maxLatencySeconds = 0.0;
+    bool registeredBuffers = false;   // Buffers registered with the kernel (fixed writes)
+    bool directIo = false;            // File actually opened with O_DIRECT
+};
+
+// Appends to a file through io_uring, without blocking on the disk.
+//
+// Bytes are copied into a pool of block-aligned buffers; each full buffer
+// is submitted as one write at its file offset and the caller carries on
+// filling the next, so up to queueDepth writes are in flight. The pool is
+// registered with the kernel when possible so writes skip the per-call
+// page pinning. The ring is driven with raw system calls, so no liburing
+// is needed.
+//
+// With direct I/O every write must cover whole blocks: flush() only writes
+// the whole blocks buffered so far and close() pads the last block, then
+// trims the file to its real length.
+//
+// isOpen() is false when io_uring is unavailable (old kernel, seccomp
+// filter, non-Linux build); callers should fall back to ordinary writes.
+class UringFileWriter {
+public:
+    // Constructor with the file to create and the writer settings
+    UringFileWriter(const std::string& path, const UringWriterConfig& config = UringWriterConfig());
+
+    // Destructor closes the file
+    ~UringFileWriter();
+
+    UringFileWriter(const UringFileWriter&) = delete;
+    UringFileWriter& operator=(const UringFileWriter&) = delete;
+
+    // Ring set up and file open
+    bool isOpen() const { return ringFd_ >= 0 && fileFd_ >= 0; }
+
+    // Append bytes, submitting every buffer that fills up
+    bool write(const char* data, size_t size);
+
+    // Submit what is buffered (whole blocks only with direct I/O)
+    bool submit();
+
+    // Submit what is buffered and wait for every write to complete
+    bool flush();
+
+    // Write the remainder, wait for completion and close the file
+    bool close();
+
+    // Counters so far
+    UringWriterStats getStats() const;
+
+private:
+    struct Buffer {
+        char* data = nullptr;
+        size_t size = 0;               // Bytes filled
+        std::uint64_t fileOffset = 0;  // Where data[0] goes in the file
+        bool inFlight = false;
+        size_t pendingFrom = 0;        // Byte range of the write in flight
+        size_t pendingTo = 0;
+        std::chrono::steady_clock::time_point submittedAt;
+    };
+
+    std::string path_;
+    UringWriterConfig config_;
+    size_t blockSize_;
+
+    int fileFd_;
+    int ringFd_;
+
+    // Mapped ring regions
+    void* sqRing_;
+    size_t sqRingSize_;
+    void* cqRing_;
+    size_t cqRingSize_;
+    void* sqes_;
+    size_t sqesSize_;
+
+    // Pointers into the rings
+    unsigned* sqHead_;
+    unsigned* sqTail_;
+    unsigned sqMask_;
+    unsigned* sqArray_;
+    unsigned* cqHead_;
+    unsigned* cqTail_;
+    unsigned cqMask_;
+    void* cqes_;
+
+    std::vector<Buffer> buffers_;
+    size_t current_;               // Buffer being filled
+    std::uint64_t nextOffset_;     // File offset after the last buffered byte
+    size_t inFlight_;
+
+    UringWriterStats stats_;
+    double latencyTotal_;
+
+    // Create the ring and map its regions
+    bool setupRing();
+
+    // Allocate the buffer pool and try to register it
+    bool setupBuffers();
+
+    // Release the ring, buffers and file
+    void teardown();
+
+    // Submit bytes [from, to) of a buffer at their file offset
+    bool submitWrite(size_t index, size_t from, size_t to);
+
+    // Process finished writes; with wait, block until at least one finishes
+    bool reap(bool wait);
+
+    // Make the current buffer one that is not in flight
+    bool nextFreeBuffer();
+};
+
+#endif // VEHICLE_SIM_URING_FILE_WRITER_H
@@ -0,0 +1,49 @@
+#ifndef VEHICLE_SIM_VEHICLE_SERIALIZER_H
+#define VEHICLE_SIM_VEHICLE_SERIALIZER_H
+
+#include "TickSnapshot.h"
+#include <ctime>
+#include <string>
+#include <vector>
+
+// Writes vehicle updates as JSON straight into a byte buffer.
+//
+// Produces exactly the bytes nlohmann::json would for the same object
+// (keys in sorted order, the library's shortest round-trip float format,
+// null for non-finite values) without building a DOM. Each vehicle's id is
+// escaped once and cached by handle, and appending to a buffer with enough
+// capacity does not allocate, so in steady state serialization is
+// allocation-free.
+//
+// The id cache is keyed by handle and checked against the id's storage,
+// so one serializer can be reused across ticks of the same simulation.
+// A serializer is not thread-safe; give each publishing thread its own.
+class VehicleJsonSerializer {
+public:
+    // Upper bound on the bytes of one record besides its escaped id
+    static constexpr size_t MaxRecordOverhead = 256;
+
+    // Append the compact JSON of a state with its timestamp, as json::dump()
+    void append(std::string& out, const VehicleState& state, std::time_t timestamp);
+
+    // Append the state without timestamp indented by two spaces, as json::dump(2)
+    void appendIndented(std::string& out, const VehicleState& state);
+
+    // Write the compact JSON into [first, last); returns the end of the
+    // written bytes, or nullptr if the record does not fit
+    char* write(char* first, char* last, const VehicleState& state, std::time_t timestamp);
+
+    // Escaped and quoted id of a state, cached by handle
+    const std::string& escapedId(const VehicleState& state);
+
+private:
+    struct CachedId {
+        const char* source = nullptr; // Storage of the id the entry was built from
+        size_t size = 0;
+        std::string escaped;
+    };
+
+    std::vector<CachedId> ids_; // Indexed by vehicle handle
+};
+
+#endif // VEHICLE_SIM_VEHICLE_SERIALIZER_H
@@ -0,0 +1,144 @@
+#include "BinaryPublisher.h"
+#include <algorithm>
+#include <iostream>
+#include <limits>
+
+namespace {
+
+// Marks handles that have no dense index yet
+constexpr std::uint32_t NoIndex = std::numeric_limits<std::uint32_t>::max();
+
+} // namespace
+
+// Constructor implementation
+BinaryPublisher::BinaryPublisher(const std::string& outputFilePath, double timeStep, size_t flushBytes)
+        : outputFilePath_(outputFilePath),
+          flushBytes_(flushBytes < TelemetryRecordSize ? TelemetryRecordSize : flushBytes),
+          hasFirstTimestamp_(false),
+          buffer_(flushBytes_ + TelemetryRecordSize),
+          buffered_(0) {
+
+    // Records are buffered here, so every flush goes straight to the file
+    outputFile_.rdbuf()->pubsetbuf(nullptr, 0);
+
+    // Open file for writing
+    outputFile_.open(outputFilePath, std::ios::out | std::ios::binary | std::ios::trunc);
+
+    if (!outputFile_.is_open()) {
+        std::cerr << "Error opening output file: " << outputFilePath << std::endl;
+        return;
+    }
+
+    // Provisional header; counts and the dictionary offset are filled in on close
+    header_.timeStep = timeStep;
+    encodeTelemetryHeader(buffer_.data(), header_);
+    buffered_ = TelemetryHeaderSize;
+    flush();
+
+    std::cout << "Binary publisher initialized successfully." << std::endl;
+}
+
+// Destructor
+BinaryPublisher::~BinaryPublisher() {
+    close();
+}
+
+// Publish a dispatcher batch
+bool BinaryPublisher::publish(const PublishBatch& batch) {
+    if (!outputFile_.is_open()) {
+        std::cerr << "Output file not opened." << std::endl;
+        return false;
+    }
+
+    bool written = true;
+    for (size_t i = 0; i < batch.count; ++i) {
+        written = appendRecord(batch.records[i].state, batch.records[i].tick, batch.records[i].timestamp) && written;
+    }
+    return written;
+}
+
+// Write everything buffered so far to the file
+bool BinaryPublisher::flush() {
+    if (buffered_ == 0) {
+        return true;
+    }
+
+    outputFile_.write(reinterpret_cast<const char*>(buffer_.data()), static_cast<std::streamsize>(buffered_));
+    buffered_ = 0;
+
+    if (!outputFile_) {
+        std::cerr << "Error writing to output file: " << outputFilePath_ << std::endl;
+        outputFile_.clear();
+        return false;
+    }
+    return true;
+}
+
+// Write the dictionary and final header and close the file
+bool BinaryPublisher::close() {
+    if (!outputFile_.is_open()) {
+        return false;
+    }
+
+    bool written = flush();
+    header_.dictionaryOffset = TelemetryHeaderSize + header_.recordCount * TelemetryRecordSize;
+
+    // Id dictionary in vehicle index order
+    std::vector<unsigned char> dictionary(4);
+    storeLE32(dictionary.data(), static_cast<std::uint32_t>(ids_.size()));
+    for (const std::string& id : ids_) {
+        size_t length = std::min<size_t>(id.size(), std::numeric_limits<std::uint16_t>::max());
+        size_t offset = dictionary.size();
+        dictionary.resize(offset + 2 + length);
+        storeLE16(dictionary.data() + offset, static_cast<std::uint16_t>(length));
+        std::copy(id.begin(), id.begin() + static_cast<std::ptrdiff_t>(length), dictionary.begin() + static_cast<std::ptrdiff_t>(offset + 2));
+    }
+    outputFile_.write(reinterpret_cast<const char*>(dictionary.data()), static_cast<std::streamsize>(dictionary.size()));
+
+    // Final header over the provisional one
+    unsigned char header[TelemetryHeaderSize];
+    encodeTelemetryHeader(header, header_);
+    outputFile_.seekp(0);
+    outputFile_.write(reinterpret_cast<const char*>(header), TelemetryHeaderSize);
+
+    if (!outputFile_) {
+        std::cerr << "Error finalizing output file: " << outputFilePath_ << std::endl;
+        written = false;
+    }
+    outputFile_.close();
+    return written;
+}
+
+// Pack one state into the buffer
+bool BinaryPublisher::appendRecord(const VehicleState& state, std::uint64_t tick, std::time_t timestamp) {
+    if (!hasFirstTimestamp_) {
+        header_.firstTimestamp = static_cast<std::int64_t>(timestamp);
+        hasFirstTimestamp_ = true;
+    }
+
+    TelemetryRecord record{vehicleIndex(state), static_cast<std::uint32_t>(tick),
+                           state.position.lat, state.position.lon,
+                           static_cast<float>(state.heading), static_cast<float>(state.speed)};
+    encodeTelemetryRecord(buffer_.data() + buffered_, record);
+    buffered_ += TelemetryRecordSize;
+    ++header_.recordCount;
+
+    if (buffered_ >= flushBytes_) {
+        return flush();
+    }
+    return true;
+}
+
+// Dense index of a vehicle, assigning the next one on first sight
+std::uint32_t BinaryPublisher::vehicleIndex(const VehicleState& state) {
+    if (state.handle >= indexByHandle_.size()) {
+        indexByHandle_.resize(static_cast<size_t>(state.handle) + 1, NoIndex);
+    }
+
+    std::uint32_t& index = indexByHandle_[state.handle];
+    if (index == NoIndex) {
+        index = static_cast<std::uint32_t>(ids_.size());
+        ids_.emplace_back(state.id);
+    }
+    return index;
+}
@@ -0,0 +1,116 @@
+#include "ConsolePublisher.h"
+#include "PublishDispatcher.h"
+#include <algorithm>
+#include <cstdio>
+
+// Constructor implementation
+ConsolePublisher::ConsolePublisher(const ConsoleConfig& config, std::ostream& out)
+        : config_(config),
+          out_(out),
+          dispatcher_(nullptr),
+          ticks_(0),
+          updates_(0),
+          vehicles_(0),
+          ticksAtSummary_(0),
+          updatesAtSummary_(0),
+          summaryAt_(std::chrono::steady_clock::now()),
+          linesPrinted_(0) {}
+
+// Summarize and sample a dispatcher batch
+bool ConsolePublisher::publish(const PublishBatch& batch) {
+    buffer_.clear();
+
+    if (!config_.sampleIds.empty() || config_.sampleEvery > 0) {
+        for (size_t i = 0; i < batch.count; ++i) {
+            const VehicleRecord& record = batch.records[i];
+            if (sampled(record.state, updates_ + i)) {
+                serializer_.append(buffer_, record.state, record.timestamp);
+                buffer_.push_back('\n');
+                ++linesPrinted_;
+            }
+        }
+    }
+
+    ++ticks_;
+    updates_ += batch.count;
+    vehicles_ = batch.count;
+
+    auto now = std::chrono::steady_clock::now();
+    if (config_.intervalSeconds > 0.0
+        && std::chrono::duration<double>(now - summaryAt_).count() >= config_.intervalSeconds) {
+        appendSummary(batch.info, now);
+    }
+
+    // One write per tick at most; the stream is flushed by flush() only
+    if (!buffer_.empty()) {
+        out_.write(buffer_.data(), static_cast<std::streamsize>(buffer_.size()));
+    }
+    return static_cast<bool>(out_);
+}
+
+// Flush the stream
+bool ConsolePublisher::flush() {
+    out_.flush();
+    return static_cast<bool>(out_);
+}
+
+// Is this update sampled
+bool ConsolePublisher::sampled(const VehicleState& state, std::uint64_t sequence) {
+    // Rate sampling counts updates, so the stride holds across ticks
+    if (config_.sampleEvery > 0 && sequence % config_.sampleEvery == 0) {
+        return true;
+    }
+
+    bool byId = false;
+    if (!config_.sampleIds.empty()) {
+        if (state.handle >= sampleCache_.size()) {
+            sampleCache_.resize(static_cast<size_t>(state.handle) + 1);
+        }
+        CachedSample& cached = sampleCache_[state.handle];
+        if (cached.source != state.id.data()) {
+            cached.source = state.id.data();
+            cached.sampled = config_.sampleIds.count(std::string(state.id)) > 0;
+        }
+        byId = cached.sampled;
+    }
+    return byId;
+}
+
+// Append the summary line for the interval ending now
+void ConsolePublisher::appendSummary(const TickInfo& info, std::chrono::steady_clock::time_point now) {
+    double seconds = std::chrono::duration<double>(now - summaryAt_).count();
+    double tickRate = static_cast<double>(ticks_ - ticksAtSummary_) / seconds;
+    double updateRate = static_cast<double>(updates_ - updatesAtSummary_) / seconds;
+
+    char line[256];
+    int length = std::snprintf(line, sizeof(line),
+                               "tick %llu (t=%.1f s): %.1f ticks/s, %llu vehicles, %.0f updates/s",
+                               static_cast<unsigned long long>(info.tick), info.simulationTime, tickRate,
+                               static_cast<unsigned long long>(vehicles_), updateRate);
+    buffer_.append(line, static_cast<size_t>(length > 0 ? std::min<int>(length, sizeof(line) - 1) : 0));
+
+    // The sink furthest behind, by ticks waiting in its queue
+    if (dispatcher_ != nullptr) {
+        size_t deepest = 0;
+        std::string deepestName;
+        for (const SinkStats& stats : dispatcher_->getStats()) {
+            if (stats.queueDepth > deepest || deepestName.empty()) {
+                deepest = stats.queueDepth;
+                deepestName = stats.name;
+            }
+        }
+        if (!deepestName.empty()) {
+            buffer_ += ", sink lag ";
+            buffer_ += std::to_string(deepest);
+            buffer_ += " ticks (";
+            buffer_ += deepestName;
+            buffer_ += ")";
+        }
+    }
+    buffer_.push_back('\n');
+    ++linesPrinted_;
+
+    ticksAtSummary_ = ticks_;
+    updatesAtSummary_ = updates_;
+    summaryAt_ = now;
+}
@@ -0,0 +1,73 @@
+#include "DeadReckoningFilter.h"
+#include <cmath>
+
+// Constructor with the thresholds
+DeadReckoningFilter::DeadReckoningFilter(const DeadReckoningConfig& config)
+        : config_(config) {}
+
+// Filter a tick
+TickSnapshot DeadReckoningFilter::filter(const TickSnapshot& snapshot) {
+    kept_.clear();
+    for (const VehicleState& state : snapshot) {
+        if (shouldPublish(state, snapshot.info.simulationTime)) {
+            kept_.push_back(state);
+        }
+    }
+    return {snapshot.info, kept_.data(), kept_.size()};
+}
+
+// Decide for one update
+bool DeadReckoningFilter::shouldPublish(const VehicleState& state, double simulationTime) {
+    ++stats_.considered;
+    if (state.handle >= reports_.size()) {
+        reports_.resize(static_cast<size_t>(state.handle) + 1);
+    }
+    LastReport& report = reports_[state.handle];
+
+    bool publish = !report.valid;
+    if (!publish) {
+        double elapsed = simulationTime - report.time;
+
+        // Straight-line extrapolation of the last report (0 = north, clockwise)
+        double travelled = report.speed * elapsed;
+        LocalPoint predicted{travelled * std::sin(report.heading), travelled * std::cos(report.heading)};
+        LocalPoint actual = report.frame.toLocal(state.position);
+
+        double headingChange = std::remainder(state.heading - report.heading, 2.0 * M_PI);
+
+        if (actual.squaredDistanceTo(predicted) > config_.distanceThreshold * config_.distanceThreshold
+            || std::fabs(headingChange) > config_.headingThreshold) {
+            publish = true;
+        } else if (elapsed >= config_.maxIntervalSeconds) {
+            publish = true;
+            ++stats_.heartbeats;
+        }
+    }
+
+    if (publish) {
+        report.valid = true;
+        report.frame = LocalProjection(state.position);
+        report.heading = state.heading;
+        report.speed = state.speed;
+        report.time = simulationTime;
+        ++stats_.published;
+    }
+    return publish;
+}
+
+// Forget a report that was dropped on the way to a consumer
+void DeadReckoningFilter::invalidate(VehicleHandle handle, double simulationTime) {
+    if (handle >= reports_.size()) {
+        return;
+    }
+    LastReport& report = reports_[handle];
+    if (report.valid && report.time <= simulationTime) {
+        report.valid = false;
+        ++stats_.invalidated;
+    }
+}
+
+// Forget every vehicle
+void DeadReckoningFilter::reset() {
+    reports_.clear();
+}
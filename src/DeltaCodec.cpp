@@ -0,0 +1,169 @@
+#include "DeltaCodec.h"
+#include <cmath>
+
+namespace {
+
+// Vehicle indices above this are treated as corrupt rather than allocated for
+constexpr std::uint64_t MaxVehicleIndex = 1u << 24;
+
+// Heading in [0, DeltaHeadingPeriod) steps
+std::int64_t quantizeHeading(double heading) {
+    std::int64_t steps = std::llround(heading * DeltaHeadingScale) % DeltaHeadingPeriod;
+    return steps < 0 ? steps + DeltaHeadingPeriod : steps;
+}
+
+// Heading change taking the short way round
+std::int64_t headingDelta(std::int64_t from, std::int64_t to) {
+    std::int64_t delta = to - from;
+    if (delta > DeltaHeadingPeriod / 2) {
+        delta -= DeltaHeadingPeriod;
+    } else if (delta < -DeltaHeadingPeriod / 2) {
+        delta += DeltaHeadingPeriod;
+    }
+    return delta;
+}
+
+// Read a zigzag varint
+bool readSigned(const unsigned char*& in, const unsigned char* end, std::int64_t& value) {
+    std::uint64_t raw;
+    if (!readVarint(in, end, raw)) {
+        return false;
+    }
+    value = zigzagDecode(raw);
+    return true;
+}
+
+// Add a delta with two's complement wrap-around; corrupt input must not
+// overflow a signed sum
+std::int64_t wrappingAdd(std::int64_t value, std::int64_t delta) {
+    return static_cast<std::int64_t>(static_cast<std::uint64_t>(value) + static_cast<std::uint64_t>(delta));
+}
+
+} // namespace
+
+// Constructor with the keyframe interval
+DeltaEncoder::DeltaEncoder(std::uint32_t keyframeInterval)
+        : keyframeInterval_(keyframeInterval),
+          generation_(1),
+          keyframes_(0),
+          deltas_(0) {}
+
+// Append the message for a state
+void DeltaEncoder::append(std::string& out, const VehicleState& state, std::uint64_t tick, std::time_t timestamp) {
+    if (state.handle >= previous_.size()) {
+        previous_.resize(static_cast<size_t>(state.handle) + 1);
+    }
+    Previous& previous = previous_[state.handle];
+
+    Quantized current;
+    current.tick = tick;
+    current.timestamp = static_cast<std::int64_t>(timestamp);
+    current.lat = std::llround(state.position.lat * DeltaCoordinateScale);
+    current.lon = std::llround(state.position.lon * DeltaCoordinateScale);
+    current.heading = quantizeHeading(state.heading);
+    current.speed = std::llround(state.speed * DeltaSpeedScale);
+
+    bool keyframe = previous.generation != generation_ || previous.sinceKeyframe >= keyframeInterval_;
+    if (keyframe) {
+        out.push_back(static_cast<char>(DeltaKeyframe));
+        appendVarint(out, state.handle);
+        appendVarint(out, current.tick);
+        appendVarint(out, zigzagEncode(current.timestamp));
+        appendVarint(out, zigzagEncode(current.lat));
+        appendVarint(out, zigzagEncode(current.lon));
+        appendVarint(out, static_cast<std::uint64_t>(current.heading));
+        appendVarint(out, zigzagEncode(current.speed));
+        appendVarint(out, state.id.size());
+        out.append(state.id.data(), state.id.size());
+        previous.sinceKeyframe = 0;
+        previous.generation = generation_;
+        ++keyframes_;
+    } else {
+        const Quantized& last = previous.values;
+        out.push_back(static_cast<char>(DeltaUpdate));
+        appendVarint(out, state.handle);
+        appendVarint(out, zigzagEncode(static_cast<std::int64_t>(current.tick - last.tick)));
+        appendVarint(out, zigzagEncode(current.timestamp - last.timestamp));
+        appendVarint(out, zigzagEncode(current.lat - last.lat));
+        appendVarint(out, zigzagEncode(current.lon - last.lon));
+        appendVarint(out, zigzagEncode(headingDelta(last.heading, current.heading)));
+        appendVarint(out, zigzagEncode(current.speed - last.speed));
+        ++previous.sinceKeyframe;
+        ++deltas_;
+    }
+    previous.values = current;
+}
+
+// Send the next message of every vehicle as a keyframe
+void DeltaEncoder::forceKeyframes() {
+    ++generation_;
+}
+
+// Decode one message
+DeltaDecodeStatus DeltaDecoder::decode(const void* data, size_t size, DeltaRecord& record) {
+    const auto* in = static_cast<const unsigned char*>(data);
+    const unsigned char* end = in + size;
+    if (in == end) {
+        return DeltaDecodeStatus::Malformed;
+    }
+
+    std::uint8_t kind = *in++;
+    std::uint64_t index;
+    if ((kind != DeltaKeyframe && kind != DeltaUpdate) || !readVarint(in, end, index) || index > MaxVehicleIndex) {
+        return DeltaDecodeStatus::Malformed;
+    }
+    if (index >= vehicles_.size()) {
+        vehicles_.resize(static_cast<size_t>(index) + 1);
+    }
+    Vehicle& vehicle = vehicles_[index];
+
+    if (kind == DeltaKeyframe) {
+        std::uint64_t tick, heading, idLength;
+        std::int64_t timestamp, lat, lon, speed;
+        if (!readVarint(in, end, tick) || !readSigned(in, end, timestamp)
+            || !readSigned(in, end, lat) || !readSigned(in, end, lon)
+            || !readVarint(in, end, heading) || !readSigned(in, end, speed)
+            || !readVarint(in, end, idLength) || idLength > static_cast<std::uint64_t>(end - in)) {
+            return DeltaDecodeStatus::Malformed;
+        }
+        vehicle.valid = true;
+        vehicle.id.assign(reinterpret_cast<const char*>(in), static_cast<size_t>(idLength));
+        vehicle.tick = tick;
+        vehicle.timestamp = timestamp;
+        vehicle.lat = lat;
+        vehicle.lon = lon;
+        vehicle.heading = static_cast<std::int64_t>(heading % DeltaHeadingPeriod);
+        vehicle.speed = speed;
+    } else {
+        std::int64_t tick, timestamp, lat, lon, heading, speed;
+        if (!readSigned(in, end, tick) || !readSigned(in, end, timestamp)
+            || !readSigned(in, end, lat) || !readSigned(in, end, lon)
+            || !readSigned(in, end, heading) || !readSigned(in, end, speed)) {
+            return DeltaDecodeStatus::Malformed;
+        }
+        if (!vehicle.valid) {
+            return DeltaDecodeStatus::NeedKeyframe;
+        }
+        vehicle.tick += static_cast<std::uint64_t>(tick);
+        vehicle.timestamp = wrappingAdd(vehicle.timestamp, timestamp);
+        vehicle.lat = wrappingAdd(vehicle.lat, lat);
+        vehicle.lon = wrappingAdd(vehicle.lon, lon);
+        // The stored heading is in [0, period), so reducing the delta first keeps the sum in range
+        vehicle.heading = (vehicle.heading + heading % DeltaHeadingPeriod) % DeltaHeadingPeriod;
+        if (vehicle.heading < 0) {
+            vehicle.heading += DeltaHeadingPeriod;
+        }
+        vehicle.speed = wrappingAdd(vehicle.speed, speed);
+    }
+
+    record.vehicleIndex = static_cast<std::uint32_t>(index);
+    record.id = vehicle.id;
+    record.tick = vehicle.tick;
+    record.timestamp = vehicle.timestamp;
+    record.lat = static_cast<double>(vehicle.lat) / DeltaCoordinateScale;
+    record.lon = static_cast<double>(vehicle.lon) / DeltaCoordinateScale;
+    record.heading = static_cast<double>(vehicle.heading) / DeltaHeadingScale;
+    record.speed = static_cast<double>(vehicle.speed) / DeltaSpeedScale;
+    record.keyframe = kind == DeltaKeyframe;
+    return DeltaDecodeStatus::Ok;
+}
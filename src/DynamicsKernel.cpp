@@ -0,0 +1,147 @@
+#include "DynamicsKernel.h"
+#include "DynamicsKernelSimd.h"
+#include <vector>
+
+// Best instruction set supported by the running CPU
+KernelIsa detectKernelIsa() {
+#if defined(VEHICLE_SIM_X86_KERNELS)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) {
+        return KernelIsa::AVX512;
+    }
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+        return KernelIsa::AVX2;
+    }
+    if (__builtin_cpu_supports("sse2")) {
+        return KernelIsa::SSE2;
+    }
+#endif
+    return KernelIsa::Scalar;
+}
+
+// Clamp a requested instruction set to what this build and CPU support
+KernelIsa resolveKernelIsa(KernelIsa requested) {
+    static const KernelIsa best = detectKernelIsa();
+    return static_cast<int>(requested) <= static_cast<int>(best) ? requested : best;
+}
+
+// Human-readable instruction set name
+const char* kernelIsaName(KernelIsa isa) {
+    switch (isa) {
+        case KernelIsa::Scalar: return "scalar";
+        case KernelIsa::SSE2: return "sse2";
+        case KernelIsa::AVX2: return "avx2";
+        case KernelIsa::AVX512: return "avx512";
+    }
+    return "unknown";
+}
+
+// Vehicles per instruction of an instruction set
+size_t kernelIsaWidth(KernelIsa isa) {
+    switch (isa) {
+        case KernelIsa::Scalar: return 1;
+        case KernelIsa::SSE2: return 2;
+        case KernelIsa::AVX2: return 4;
+        case KernelIsa::AVX512: return 8;
+    }
+    return 1;
+}
+
+// Advance slots [begin, end) with the given instruction set
+size_t advanceFleetBatch(KernelIsa isa, const FleetKernelView& view,
+                         size_t begin, size_t end, double deltaTime) {
+    KernelBlockResult blocks{begin, 0};
+
+#if defined(VEHICLE_SIM_X86_KERNELS)
+    switch (isa) {
+        case KernelIsa::AVX512:
+            blocks = advanceFleetBlocksAVX512(view, begin, end, deltaTime);
+            break;
+        case KernelIsa::AVX2:
+            blocks = advanceFleetBlocksAVX2(view, begin, end, deltaTime);
+            break;
+        case KernelIsa::SSE2:
+            blocks = advanceFleetBlocksSSE2(view, begin, end, deltaTime);
+            break;
+        case KernelIsa::Scalar:
+            break;
+    }
+#else
+    (void)isa;
+#endif
+
+    // Scalar tail (or everything, without vector kernels)
+    size_t reached = blocks.reached;
+    for (size_t slot = blocks.end; slot < end; ++slot) {
+        bool arrived = stepVehicleScalar(view, slot, deltaTime);
+        view.reached[slot] = arrived ? 1 : 0;
+        reached += arrived ? 1 : 0;
+    }
+    return reached;
+}
+
+namespace {
+
+// Writable copy of the mutable per-slot arrays of a range
+struct KernelScratch {
+    std::vector<double> x;
+    std::vector<double> y;
+    std::vector<double> heading;
+    std::vector<double> speed;
+    std::vector<std::uint8_t> reached;
+
+    KernelScratch(const FleetKernelView& view, size_t begin, size_t end)
+            : x(view.x + begin, view.x + end),
+              y(view.y + begin, view.y + end),
+              heading(view.heading + begin, view.heading + end),
+              speed(view.speed + begin, view.speed + end),
+              reached(end - begin, 0) {}
+
+    // View over the copy, with read-only arrays shared with the source
+    FleetKernelView view(const FleetKernelView& source, size_t begin) {
+        return {x.data(), y.data(), heading.data(), speed.data(),
+                source.maxSpeed + begin, source.acceleration + begin,
+                source.deceleration + begin, source.waypointThreshold + begin,
+                source.targetX + begin, source.targetY + begin,
+                source.completed + begin, reached.data()};
+    }
+};
+
+} // namespace
+
+// Run the scalar and the given kernel side by side and diff the results
+KernelDiff compareKernels(KernelIsa isa, const FleetKernelView& view,
+                          size_t begin, size_t end, double deltaTime) {
+    KernelDiff diff;
+    if (end <= begin) {
+        return diff;
+    }
+
+    size_t count = end - begin;
+    KernelScratch reference(view, begin, end);
+    KernelScratch candidate(view, begin, end);
+
+    FleetKernelView referenceView = reference.view(view, begin);
+    for (size_t i = 0; i < count; ++i) {
+        reference.reached[i] = stepVehicleScalar(referenceView, i, deltaTime) ? 1 : 0;
+    }
+    advanceFleetBatch(isa, candidate.view(view, begin), 0, count, deltaTime);
+
+    for (size_t i = 0; i < count; ++i) {
+        LocalPoint expected{reference.x[i], reference.y[i]};
+        LocalPoint actual{candidate.x[i], candidate.y[i]};
+        diff.maxPositionError = std::max(diff.maxPositionError, expected.distanceTo(actual));
+
+        double headingError = std::fabs(reference.heading[i] - candidate.heading[i]);
+        headingError = std::min(headingError, std::fabs(2 * M_PI - headingError));
+        diff.maxHeadingError = std::max(diff.maxHeadingError, headingError);
+
+        diff.maxSpeedError = std::max(diff.maxSpeedError, std::fabs(reference.speed[i] - candidate.speed[i]));
+
+        if (reference.reached[i] != candidate.reached[i]) {
+            ++diff.waypointMismatches;
+        }
+    }
+    diff.vehiclesCompared = count;
+    return diff;
+}
@@ -0,0 +1,50 @@
+// AVX2 + FMA build of the batched dynamics kernel (4 vehicles per instruction)
+#include "DynamicsKernelSimd.h"
+#include <cstring>
+#include <immintrin.h>
+
+namespace {
+
+struct VecAVX2 {
+    using Reg = __m256d;
+    using Mask = __m256d;
+    static constexpr size_t Width = 4;
+
+    static Reg load(const double* p) { return _mm256_loadu_pd(p); }
+    static void store(double* p, Reg v) { _mm256_storeu_pd(p, v); }
+    static Reg set1(double v) { return _mm256_set1_pd(v); }
+
+    static Reg add(Reg a, Reg b) { return _mm256_add_pd(a, b); }
+    static Reg sub(Reg a, Reg b) { return _mm256_sub_pd(a, b); }
+    static Reg mul(Reg a, Reg b) { return _mm256_mul_pd(a, b); }
+    static Reg div(Reg a, Reg b) { return _mm256_div_pd(a, b); }
+    static Reg fma(Reg a, Reg b, Reg c) { return _mm256_fmadd_pd(a, b, c); }
+    static Reg min(Reg a, Reg b) { return _mm256_min_pd(a, b); }
+    static Reg max(Reg a, Reg b) { return _mm256_max_pd(a, b); }
+    static Reg sqrt(Reg a) { return _mm256_sqrt_pd(a); }
+    static Reg abs(Reg a) { return _mm256_andnot_pd(_mm256_set1_pd(-0.0), a); }
+    static Reg round(Reg a) { return _mm256_round_pd(a, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC); }
+    static Reg floor(Reg a) { return _mm256_floor_pd(a); }
+
+    static Mask lt(Reg a, Reg b) { return _mm256_cmp_pd(a, b, _CMP_LT_OQ); }
+    static Mask le(Reg a, Reg b) { return _mm256_cmp_pd(a, b, _CMP_LE_OQ); }
+    static Mask gt(Reg a, Reg b) { return _mm256_cmp_pd(a, b, _CMP_GT_OQ); }
+    static Mask eq(Reg a, Reg b) { return _mm256_cmp_pd(a, b, _CMP_EQ_OQ); }
+    static Mask orMask(Mask a, Mask b) { return _mm256_or_pd(a, b); }
+    static Mask andNot(Mask a, Mask b) { return _mm256_andnot_pd(b, a); }
+    static Reg select(Mask m, Reg a, Reg b) { return _mm256_blendv_pd(b, a, m); }
+
+    static Mask loadFlags(const std::uint8_t* p) {
+        int packed;
+        std::memcpy(&packed, p, sizeof(packed));
+        __m256i wide = _mm256_cvtepu8_epi64(_mm_cvtsi32_si128(packed));
+        return _mm256_castsi256_pd(_mm256_cmpgt_epi64(wide, _mm256_setzero_si256()));
+    }
+    static unsigned bits(Mask m) { return static_cast<unsigned>(_mm256_movemask_pd(m)); }
+};
+
+} // namespace
+
+KernelBlockResult advanceFleetBlocksAVX2(const FleetKernelView& view, size_t begin, size_t end, double deltaTime) {
+    return advanceBlocks<VecAVX2>(view, begin, end, deltaTime);
+}
@@ -0,0 +1,58 @@
+// AVX-512F build of the batched dynamics kernel (8 vehicles per instruction)
+#include "DynamicsKernelSimd.h"
+
+// GCC's AVX-512 intrinsics start from a deliberately undefined register
+// (__m512d __Y = __Y) that is fully overwritten, which -Wmaybe-uninitialized
+// reports wherever they are inlined; the warning points into the header
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#include <immintrin.h>
+#pragma GCC diagnostic pop
+#else
+#include <immintrin.h>
+#endif
+
+namespace {
+
+struct VecAVX512 {
+    using Reg = __m512d;
+    using Mask = __mmask8;
+    static constexpr size_t Width = 8;
+
+    static Reg load(const double* p) { return _mm512_loadu_pd(p); }
+    static void store(double* p, Reg v) { _mm512_storeu_pd(p, v); }
+    static Reg set1(double v) { return _mm512_set1_pd(v); }
+
+    static Reg add(Reg a, Reg b) { return _mm512_add_pd(a, b); }
+    static Reg sub(Reg a, Reg b) { return _mm512_sub_pd(a, b); }
+    static Reg mul(Reg a, Reg b) { return _mm512_mul_pd(a, b); }
+    static Reg div(Reg a, Reg b) { return _mm512_div_pd(a, b); }
+    static Reg fma(Reg a, Reg b, Reg c) { return _mm512_fmadd_pd(a, b, c); }
+    static Reg min(Reg a, Reg b) { return _mm512_min_pd(a, b); }
+    static Reg max(Reg a, Reg b) { return _mm512_max_pd(a, b); }
+    static Reg sqrt(Reg a) { return _mm512_sqrt_pd(a); }
+    static Reg abs(Reg a) { return _mm512_abs_pd(a); }
+    static Reg round(Reg a) { return _mm512_roundscale_pd(a, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC); }
+    static Reg floor(Reg a) { return _mm512_roundscale_pd(a, _MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC); }
+
+    static Mask lt(Reg a, Reg b) { return _mm512_cmp_pd_mask(a, b, _CMP_LT_OQ); }
+    static Mask le(Reg a, Reg b) { return _mm512_cmp_pd_mask(a, b, _CMP_LE_OQ); }
+    static Mask gt(Reg a, Reg b) { return _mm512_cmp_pd_mask(a, b, _CMP_GT_OQ); }
+    static Mask eq(Reg a, Reg b) { return _mm512_cmp_pd_mask(a, b, _CMP_EQ_OQ); }
+    static Mask orMask(Mask a, Mask b) { return static_cast<Mask>(a | b); }
+    static Mask andNot(Mask a, Mask b) { return static_cast<Mask>(a & ~b); }
+    static Reg select(Mask m, Reg a, Reg b) { return _mm512_mask_blend_pd(m, b, a); }
+
+    static Mask loadFlags(const std::uint8_t* p) {
+        __m512i wide = _mm512_cvtepu8_epi64(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(p)));
+        return _mm512_test_epi64_mask(wide, wide);
+    }
+    static unsigned bits(Mask m) { return static_cast<unsigned>(m); }
+};
+
+} // namespace
+
+KernelBlockResult advanceFleetBlocksAVX512(const FleetKernelView& view, size_t begin, size_t end, double deltaTime) {
+    return advanceBlocks<VecAVX512>(view, begin, end, deltaTime);
+}
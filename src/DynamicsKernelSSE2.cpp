@@ -0,0 +1,54 @@
+// SSE2 build of the batched dynamics kernel (2 vehicles per instruction)
+#include "DynamicsKernelSimd.h"
+#include <emmintrin.h>
+
+namespace {
+
+struct VecSSE2 {
+    using Reg = __m128d;
+    using Mask = __m128d;
+    static constexpr size_t Width = 2;
+
+    static Reg load(const double* p) { return _mm_loadu_pd(p); }
+    static void store(double* p, Reg v) { _mm_storeu_pd(p, v); }
+    static Reg set1(double v) { return _mm_set1_pd(v); }
+
+    static Reg add(Reg a, Reg b) { return _mm_add_pd(a, b); }
+    static Reg sub(Reg a, Reg b) { return _mm_sub_pd(a, b); }
+    static Reg mul(Reg a, Reg b) { return _mm_mul_pd(a, b); }
+    static Reg div(Reg a, Reg b) { return _mm_div_pd(a, b); }
+    static Reg fma(Reg a, Reg b, Reg c) { return _mm_add_pd(_mm_mul_pd(a, b), c); }
+    static Reg min(Reg a, Reg b) { return _mm_min_pd(a, b); }
+    static Reg max(Reg a, Reg b) { return _mm_max_pd(a, b); }
+    static Reg sqrt(Reg a) { return _mm_sqrt_pd(a); }
+    static Reg abs(Reg a) { return _mm_andnot_pd(_mm_set1_pd(-0.0), a); }
+
+    // Round to nearest even via the 2^52 + 2^51 trick (SSE2 has no roundpd)
+    static Reg round(Reg a) {
+        const Reg magic = _mm_set1_pd(6755399441055744.0);
+        return _mm_sub_pd(_mm_add_pd(a, magic), magic);
+    }
+    static Reg floor(Reg a) {
+        Reg r = round(a);
+        return _mm_sub_pd(r, _mm_and_pd(_mm_cmpgt_pd(r, a), _mm_set1_pd(1.0)));
+    }
+
+    static Mask lt(Reg a, Reg b) { return _mm_cmplt_pd(a, b); }
+    static Mask le(Reg a, Reg b) { return _mm_cmple_pd(a, b); }
+    static Mask gt(Reg a, Reg b) { return _mm_cmpgt_pd(a, b); }
+    static Mask eq(Reg a, Reg b) { return _mm_cmpeq_pd(a, b); }
+    static Mask orMask(Mask a, Mask b) { return _mm_or_pd(a, b); }
+    static Mask andNot(Mask a, Mask b) { return _mm_andnot_pd(b, a); }
+    static Reg select(Mask m, Reg a, Reg b) { return _mm_or_pd(_mm_and_pd(m, a), _mm_andnot_pd(m, b)); }
+
+    static Mask loadFlags(const std::uint8_t* p) {
+        return _mm_castsi128_pd(_mm_set_epi64x(p[1] ? -1 : 0, p[0] ? -1 : 0));
+    }
+    static unsigned bits(Mask m) { return static_cast<unsigned>(_mm_movemask_pd(m)); }
+};
+
+} // namespace
+
+KernelBlockResult advanceFleetBlocksSSE2(const FleetKernelView& view, size_t begin, size_t end, double deltaTime) {
+    return advanceBlocks<VecSSE2>(view, begin, end, deltaTime);
+}
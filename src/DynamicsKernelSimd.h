@@ -0,0 +1,207 @@
+#ifndef VEHICLE_SIM_DYNAMICS_KERNEL_SIMD_H
+#define VEHICLE_SIM_DYNAMICS_KERNEL_SIMD_H
+
+// Batched dynamics kernel shared by the per-ISA translation units.
+//
+// Each DynamicsKernel<ISA>.cpp is compiled with its own -m flags, defines a
+// vector type in an anonymous namespace and instantiates advanceBlocks()
+// with it. Everything here must stay internal to those translation units
+// and must not call inline library code that the linker could share with
+// the baseline build, or a non-AVX machine could end up running AVX code.
+
+#include "DynamicsKernel.h"
+
+// Result of advancing whole vector blocks
+struct KernelBlockResult {
+    size_t end;     // First slot that was not processed (start of the scalar tail)
+    size_t reached; // Number of processed slots that reached their waypoint
+};
+
+// Entry points implemented by the per-ISA translation units
+KernelBlockResult advanceFleetBlocksSSE2(const FleetKernelView& view, size_t begin, size_t end, double deltaTime);
+KernelBlockResult advanceFleetBlocksAVX2(const FleetKernelView& view, size_t begin, size_t end, double deltaTime);
+KernelBlockResult advanceFleetBlocksAVX512(const FleetKernelView& view, size_t begin, size_t end, double deltaTime);
+
+namespace {
+
+// Vectorized atan2(y, x).
+//
+// Reduces to t = min(|x|, |y|) / max(|x|, |y|) in [0, 1] and evaluates
+// atan(t) = t * P(t²) with a degree-12 polynomial (Chebyshev interpolant of
+// atan(√u)/√u on [0, 1]), then restores the octant. Polynomial error is
+// below 6e-12 rad over the whole range; with the division and octant fix-up
+// the result stays within 1e-11 rad of std::atan2. atan2(0, 0) returns 0.
+template <typename V>
+typename V::Reg atan2Approx(typename V::Reg y, typename V::Reg x) {
+    using Reg = typename V::Reg;
+
+    const Reg zero = V::set1(0.0);
+    Reg ax = V::abs(x);
+    Reg ay = V::abs(y);
+    Reg mx = V::max(ax, ay);
+    Reg mn = V::min(ax, ay);
+    Reg t = V::select(V::eq(mx, zero), zero, V::div(mn, V::select(V::eq(mx, zero), V::set1(1.0), mx)));
+    Reg u = V::mul(t, t);
+
+    Reg p = V::set1(0.00041922923320761096);
+    p = V::fma(p, u, V::set1(-0.003195431620742266));
+    p = V::fma(p, u, V::set1(0.01142764442976421));
+    p = V::fma(p, u, V::set1(-0.02600600302237301));
+    p = V::fma(p, u, V::set1(0.043646585231796896));
+    p = V::fma(p, u, V::set1(-0.060221953008854495));
+    p = V::fma(p, u, V::set1(0.07495261502248678));
+    p = V::fma(p, u, V::set1(-0.09049178707593561));
+    p = V::fma(p, u, V::set1(0.11105306632378169));
+    p = V::fma(p, u, V::set1(-0.1428522559330104));
+    p = V::fma(p, u, V::set1(0.19999978335070587));
+    p = V::fma(p, u, V::set1(-0.33333332951620576));
+    p = V::fma(p, u, V::set1(0.9999999999887356));
+    Reg r = V::mul(t, p);
+
+    r = V::select(V::gt(ay, ax), V::sub(V::set1(M_PI / 2), r), r);
+    r = V::select(V::lt(x, zero), V::sub(V::set1(M_PI), r), r);
+    return V::select(V::lt(y, zero), V::sub(zero, r), r);
+}
+
+// Vectorized sin and cos of the same argument.
+//
+// Reduces by the nearest multiple of π/2 (two-constant Cody-Waite), then
+// evaluates the degree-13 sine and degree-14 cosine Taylor polynomials on
+// [-π/4, π/4] and swaps/negates by quadrant. Absolute error is below 5e-14
+// for |x| <= 8, which covers headings in [0, 2π]; accuracy degrades for
+// large arguments since the reduction is not exact.
+template <typename V>
+void sincosApprox(typename V::Reg x, typename V::Reg& sinOut, typename V::Reg& cosOut) {
+    using Reg = typename V::Reg;
+    using Mask = typename V::Mask;
+
+    const double pio2Hi = 1.57079632679489655800e+00;
+    const double pio2Lo = 6.12323399573676603587e-17;
+
+    Reg q = V::round(V::mul(x, V::set1(2.0 / M_PI)));
+    Reg r = V::fma(q, V::set1(-pio2Hi), x);
+    r = V::fma(q, V::set1(-pio2Lo), r);
+    Reg z = V::mul(r, r);
+
+    Reg s = V::set1(1.0 / 6227020800.0);
+    s = V::fma(s, z, V::set1(-1.0 / 39916800.0));
+    s = V::fma(s, z, V::set1(1.0 / 362880.0));
+    s = V::fma(s, z, V::set1(-1.0 / 5040.0));
+    s = V::fma(s, z, V::set1(1.0 / 120.0));
+    s = V::fma(s, z, V::set1(-1.0 / 6.0));
+    s = V::fma(s, z, V::set1(1.0));
+    s = V::mul(s, r);
+
+    Reg c = V::set1(-1.0 / 87178291200.0);
+    c = V::fma(c, z, V::set1(1.0 / 479001600.0));
+    c = V::fma(c, z, V::set1(-1.0 / 3628800.0));
+    c = V::fma(c, z, V::set1(1.0 / 40320.0));
+    c = V::fma(c, z, V::set1(-1.0 / 720.0));
+    c = V::fma(c, z, V::set1(1.0 / 24.0));
+    c = V::fma(c, z, V::set1(-0.5));
+    c = V::fma(c, z, V::set1(1.0));
+
+    // Quadrant in {0, 1, 2, 3}
+    Reg quadrant = V::sub(q, V::mul(V::set1(4.0), V::floor(V::mul(q, V::set1(0.25)))));
+    Mask q1 = V::eq(quadrant, V::set1(1.0));
+    Mask q2 = V::eq(quadrant, V::set1(2.0));
+    Mask q3 = V::eq(quadrant, V::set1(3.0));
+
+    Mask swap = V::orMask(q1, q3);
+    Reg sinBase = V::select(swap, c, s);
+    Reg cosBase = V::select(swap, s, c);
+
+    const Reg zero = V::set1(0.0);
+    sinOut = V::select(V::orMask(q2, q3), V::sub(zero, sinBase), sinBase);
+    cosOut = V::select(V::orMask(q1, q2), V::sub(zero, cosBase), cosBase);
+}
+
+// Advance whole blocks of V::Width slots starting at begin.
+//
+// Mirrors stepVehicleScalar() lane by lane with branches turned into
+// selects. Angle wrapping uses round/floor instead of while loops, which
+// only differs from the scalar path for headings exactly on the wrap point.
+template <typename V>
+KernelBlockResult advanceBlocks(const FleetKernelView& view, size_t begin, size_t end, double deltaTime) {
+    using Reg = typename V::Reg;
+    using Mask = typename V::Mask;
+
+    const Reg zero = V::set1(0.0);
+    const Reg twoPi = V::set1(2 * M_PI);
+    const Reg invTwoPi = V::set1(1.0 / (2 * M_PI));
+    const Reg dt = V::set1(deltaTime);
+    const Reg headingGain = V::set1(2.0 * deltaTime);
+    const Reg three = V::set1(3.0);
+
+    size_t reached = 0;
+    size_t slot = begin;
+    for (; slot + V::Width <= end; slot += V::Width) {
+        Mask done = V::loadFlags(view.completed + slot);
+
+        Reg x = V::load(view.x + slot);
+        Reg y = V::load(view.y + slot);
+        Reg targetX = V::load(view.targetX + slot);
+        Reg targetY = V::load(view.targetY + slot);
+        Reg heading = V::load(view.heading + slot);
+        Reg speed = V::load(view.speed + slot);
+        Reg maxSpeed = V::load(view.maxSpeed + slot);
+        Reg threshold = V::load(view.waypointThreshold + slot);
+
+        // Heading towards the waypoint, wrapped difference, wrapped result
+        Reg dx = V::sub(targetX, x);
+        Reg dy = V::sub(targetY, y);
+        Reg targetHeading = atan2Approx<V>(dx, dy);
+        Reg headingDiff = V::sub(targetHeading, heading);
+        headingDiff = V::fma(V::round(V::mul(headingDiff, invTwoPi)), V::sub(zero, twoPi), headingDiff);
+        Reg newHeading = V::fma(headingDiff, headingGain, heading);
+        newHeading = V::fma(V::floor(V::mul(newHeading, invTwoPi)), V::sub(zero, twoPi), newHeading);
+
+        // Target speed slows down inside three waypoint thresholds
+        Reg distance = V::sqrt(V::fma(dx, dx, V::mul(dy, dy)));
+        Reg slowRadius = V::mul(three, threshold);
+        Reg targetSpeed = V::select(V::lt(distance, slowRadius),
+                                    V::mul(maxSpeed, V::div(distance, slowRadius)), maxSpeed);
+
+        // Accelerate or decelerate towards the target speed
+        Reg accelStep = V::mul(V::load(view.acceleration + slot), dt);
+        Reg decelStep = V::mul(V::load(view.deceleration + slot), dt);
+        Reg accelerated = V::min(V::add(speed, accelStep), targetSpeed);
+        Reg decelerated = V::max(V::sub(speed, decelStep), targetSpeed);
+        Reg moving = V::select(V::lt(speed, targetSpeed), accelerated,
+                               V::select(V::gt(speed, targetSpeed), decelerated, speed));
+        Reg newSpeed = V::select(V::gt(speed, zero), moving, V::min(accelStep, targetSpeed));
+        newSpeed = V::max(zero, V::min(newSpeed, maxSpeed));
+
+        // Move along the new heading
+        Reg sinHeading;
+        Reg cosHeading;
+        sincosApprox<V>(newHeading, sinHeading, cosHeading);
+        Reg step = V::mul(newSpeed, dt);
+        Reg newX = V::fma(step, sinHeading, x);
+        Reg newY = V::fma(step, cosHeading, y);
+
+        // Waypoint check against the moved position, on squared distances
+        Reg rdx = V::sub(targetX, newX);
+        Reg rdy = V::sub(targetY, newY);
+        Mask arrived = V::andNot(V::le(V::fma(rdx, rdx, V::mul(rdy, rdy)), V::mul(threshold, threshold)), done);
+
+        // Completed lanes keep their state and stop
+        V::store(view.heading + slot, V::select(done, heading, newHeading));
+        V::store(view.speed + slot, V::select(done, zero, newSpeed));
+        V::store(view.x + slot, V::select(done, x, newX));
+        V::store(view.y + slot, V::select(done, y, newY));
+
+        unsigned bits = V::bits(arrived);
+        for (size_t lane = 0; lane < V::Width; ++lane) {
+            unsigned flag = (bits >> lane) & 1u;
+            view.reached[slot + lane] = static_cast<std::uint8_t>(flag);
+            reached += flag;
+        }
+    }
+
+    return {slot, reached};
+}
+
+} // namespace
+
+#endif // VEHICLE_SIM_DYNAMICS_KERNEL_SIMD_H
@@ -1,67 +1,371 @@
 #include "FilePublisher.h"
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
 #include <iostream>
+#include <nlohmann/json.hpp>
 
-using json = nlohmann::json;
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+// Flush a file's contents to disk; a no-op where fsync is unavailable
+bool syncFile(const std::string& path) {
+#if !defined(_WIN32)
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        std::cerr << "Error opening " << path << " for sync: " << std::strerror(errno) << std::endl;
+        return false;
+    }
+    bool synced = ::fsync(fd) == 0;
+    if (!synced) {
+        std::cerr << "Error syncing " << path << ": " << std::strerror(errno) << std::endl;
+    }
+    ::close(fd);
+    return synced;
+#else
+    (void)path;
+    return true;
+#endif
+}
+
+// Make a rename durable by syncing the directory that holds the file
+bool syncParentDirectory(const std::string& path) {
+    size_t slash = path.find_last_of("/\\");
+    std::string directory = slash == std::string::npos ? "." : path.substr(0, slash == 0 ? 1 : slash);
+    return syncFile(directory);
+}
+
+} // namespace
 
 // Constructor implementation
-FilePublisher::FilePublisher(const std::string& outputFilePath)
-        : outputFilePath_(outputFilePath) {
+FilePublisher::FilePublisher(const std::string& outputFilePath, FileFormat format, const FlushPolicy& flushPolicy,
+                             FileBackend backend, const UringWriterConfig& uringConfig,
+                             const RotationPolicy& rotation)
+        : outputFilePath_(outputFilePath),
+          format_(format),
+          flushPolicy_(flushPolicy),
+          backend_(backend),
+          uringConfig_(uringConfig),
+          rotation_(rotation),
+          bufferedRecords_(0),
+          recordsWritten_(0),
+          flushCount_(0),
+          lastFlush_(std::chrono::steady_clock::now()),
+          segmentHasTick_(false),
+          segmentWritten_(0),
+          nextSegmentIndex_(0) {
 
-    // Open file for writing
-    outputFile_.open(outputFilePath, std::ios::out);
+    buffer_.reserve(flushPolicy_.bytes > 0 ? flushPolicy_.bytes + 4096 : 1 << 20);
 
-    if (!outputFile_.is_open()) {
-        std::cerr << "Error opening output file: " << outputFilePath << std::endl;
-        return;
+    // Direct I/O holds back the last partial block until close, so a
+    // flushed NDJSON file would not end on a complete line
+    if (format_ == FileFormat::Ndjson && backend_ == FileBackend::IoUring && uringConfig_.directIo) {
+        std::cerr << "Direct I/O is not supported for NDJSON output; using the page cache." << std::endl;
+        uringConfig_.directIo = false;
     }
 
-    // Write opening bracket for JSON array
-    outputFile_ << "[" << std::endl;
+    bool opened = isRotating() ? startSegment() : openFile(outputFilePath);
+    if (!opened) {
+        return;
+    }
 
     std::cout << "File publisher initialized successfully." << std::endl;
 }
 
 // Destructor
 FilePublisher::~FilePublisher() {
-    if (outputFile_.is_open()) {
-        // Write closing bracket for JSON array
-        outputFile_ << "]" << std::endl;
-        outputFile_.close();
+    if (isOpen()) {
+        if (isRotating()) {
+            finishSegment();
+            writeManifest(true);
+        } else {
+            closeFile();
+        }
     }
 }
 
-// Publish vehicle update
-bool FilePublisher::publishVehicleUpdate(const Vehicle& vehicle) {
-    if (!outputFile_.is_open()) {
+// Publish a dispatcher batch
+bool FilePublisher::publish(const PublishBatch& batch) {
+    if (!isOpen()) {
         std::cerr << "Output file not opened." << std::endl;
         return false;
     }
 
-    // Convert vehicle to JSON string
-    std::string payload = vehicleToJson(vehicle);
+    bool written = beginTick(batch.info.tick, batch.info.simulationTime);
+    for (size_t i = 0; i < batch.count; ++i) {
+        written = appendEncoded(batch.jsonAt(i), batch.records[i].state) && written;
+    }
+    return finishPublish() && written;
+}
+
+// Write everything buffered so far to the file
+bool FilePublisher::flush() {
+    bool written = writeBuffer();
+    if (uringWriter_) {
+        written = uringWriter_->flush() && written;
+    }
+    return written;
+}
+
+// Hand the buffer to the backend
+bool FilePublisher::writeBuffer() {
+    lastFlush_ = std::chrono::steady_clock::now();
+    if (buffer_.empty()) {
+        return true;
+    }
+
+    segmentWritten_ += buffer_.size();
+    if (uringWriter_) {
+        // Queued, not waited for; the writer only blocks once every buffer is in flight
+        bool queued = uringWriter_->write(buffer_.data(), buffer_.size()) && uringWriter_->submit();
+        buffer_.clear();
+        bufferedRecords_ = 0;
+        ++flushCount_;
+        return queued;
+    }
+
+    outputFile_.write(buffer_.data(), static_cast<std::streamsize>(buffer_.size()));
+    buffer_.clear();
+    bufferedRecords_ = 0;
+    ++flushCount_;
+
+    if (!outputFile_) {
+        std::cerr << "Error writing to output file: " << outputFilePath_ << std::endl;
+        outputFile_.clear();
+        return false;
+    }
+    return true;
+}
+
+// Append one already serialized record
+bool FilePublisher::appendEncoded(std::string_view json, const VehicleState& state) {
+    beginEntry();
+    buffer_.append(json.data(), json.size());
+    return endEntry(state);
+}
+
+// Separator before a record
+void FilePublisher::beginEntry() {
+    if (format_ == FileFormat::JsonArray) {
+        buffer_ += segment_.records > 0 ? ",\n  " : "  ";
+    }
+}
+
+// Line end and flush check after a record
+bool FilePublisher::endEntry(const VehicleState& state) {
+    if (format_ == FileFormat::Ndjson) {
+        buffer_ += '\n';
+    }
+    ++bufferedRecords_;
+    ++recordsWritten_;
+    ++segment_.records;
+
+    // Distinct vehicles per segment, for the manifest
+    if (state.handle >= vehicleSegment_.size()) {
+        vehicleSegment_.resize(static_cast<size_t>(state.handle) + 1, 0);
+    }
+    if (vehicleSegment_[state.handle] != segment_.index + 1) {
+        vehicleSegment_[state.handle] = segment_.index + 1;
+        ++segment_.vehicles;
+    }
+
+    if ((flushPolicy_.bytes > 0 && buffer_.size() >= flushPolicy_.bytes)
+        || (flushPolicy_.records > 0 && bufferedRecords_ >= flushPolicy_.records)) {
+        return writeBuffer();
+    }
+    return true;
+}
+
+// Flush at the end of a publish call if the policy asks for it
+bool FilePublisher::finishPublish() {
+    if (buffer_.empty()) {
+        return true;
+    }
+    if (flushPolicy_.everyTick) {
+        return writeBuffer();
+    }
+    if (flushPolicy_.intervalSeconds > 0.0) {
+        std::chrono::duration<double> sinceFlush = std::chrono::steady_clock::now() - lastFlush_;
+        if (sinceFlush.count() >= flushPolicy_.intervalSeconds) {
+            return writeBuffer();
+        }
+    }
+    return true;
+}
+
+// Open a file with the configured backend
+bool FilePublisher::openFile(const std::string& path) {
+    if (backend_ == FileBackend::IoUring) {
+        uringWriter_ = std::make_unique<UringFileWriter>(path, uringConfig_);
+        if (!uringWriter_->isOpen()) {
+            std::cerr << "Falling back to buffered writes for " << path << std::endl;
+            uringWriter_.reset();
+        }
+    }
+
+    // Records are buffered here, so every flush goes straight to the file
+    if (!uringWriter_) {
+        outputFile_.rdbuf()->pubsetbuf(nullptr, 0);
+        outputFile_.open(path, std::ios::out | std::ios::binary | std::ios::trunc);
+    }
 
-    // Check if this is not the first entry (we need a comma)
-    if (outputFile_.tellp() > 2) {
-        outputFile_ << "," << std::endl;
+    if (!isOpen()) {
+        std::cerr << "Error opening output file: " << path << std::endl;
+        return false;
     }
 
-    // Write to file
-    outputFile_ << "  " << payload;
-    outputFile_.flush();
+    segmentWritten_ = 0;
 
+    // Write opening bracket for JSON array
+    if (format_ == FileFormat::JsonArray) {
+        buffer_ += "[\n";
+        writeBuffer();
+    }
     return true;
 }
 
-// Convert vehicle to JSON string
-std::string FilePublisher::vehicleToJson(const Vehicle& vehicle) {
-    json j;
-    j["id"] = vehicle.getId();
-    j["timestamp"] = std::time(nullptr);
-    j["position"] = {
-            {"lat", vehicle.getPosition().lat},
-            {"lon", vehicle.getPosition().lon}
+// Terminate, write out and close the current file
+bool FilePublisher::closeFile() {
+    // Write closing bracket for JSON array
+    if (format_ == FileFormat::JsonArray) {
+        buffer_ += "]\n";
+    }
+    bool closed = writeBuffer();
+    if (uringWriter_) {
+        closed = uringWriter_->close() && closed;
+        uringWriter_.reset();
+    } else {
+        outputFile_.close();
+        closed = !outputFile_.fail() && closed;
+        outputFile_.clear();
+    }
+    return closed;
+}
+
+// Note the tick of the next records, rotating first if a limit is reached
+bool FilePublisher::beginTick(std::uint64_t tick, double simulationTime) {
+    bool rotated = true;
+    if (isRotating() && segmentHasTick_ && tick != segment_.lastTick && segment_.records > 0) {
+        bool full = rotation_.bytes > 0 && segmentWritten_ + buffer_.size() >= rotation_.bytes;
+        bool old = rotation_.simulationSeconds > 0.0
+                   && simulationTime - segment_.startTime >= rotation_.simulationSeconds;
+        if (full || old) {
+            // Each step runs even if an earlier one failed, so output keeps going to a fresh segment
+            bool finished = finishSegment();
+            bool started = startSegment();
+            bool listed = writeManifest(false);
+            rotated = finished && started && listed;
+        }
+    }
+
+    if (!segmentHasTick_) {
+        segment_.firstTick = tick;
+        segment_.startTime = simulationTime;
+        segmentHasTick_ = true;
+    }
+    segment_.lastTick = tick;
+    segment_.endTime = simulationTime;
+    return rotated;
+}
+
+// Finish the current segment: close, sync and rename it
+bool FilePublisher::finishSegment() {
+    std::string partialPath = segment_.path + ".partial";
+    bool finished = closeFile();
+
+    // An empty segment is not worth a file or a manifest entry
+    if (segment_.records == 0) {
+        std::remove(partialPath.c_str());
+        return finished;
+    }
+
+    // Make the contents durable before the rename makes them visible.
+    // A failed rename leaves the data under its partial name; the next
+    // segment still takes a new index, so it is never overwritten.
+    finished = syncFile(partialPath) && finished;
+    segment_.bytes = segmentWritten_;
+    if (std::rename(partialPath.c_str(), segment_.path.c_str()) != 0) {
+        std::cerr << "Error renaming segment " << partialPath << ": " << std::strerror(errno) << std::endl;
+        return false;
+    }
+    segments_.push_back(segment_);
+    return syncParentDirectory(segment_.path) && finished;
+}
+
+// Open the next segment under its partial name
+bool FilePublisher::startSegment() {
+    std::uint64_t index = nextSegmentIndex_++;
+    segment_ = SegmentInfo();
+    segment_.index = index;
+    segment_.path = segmentPath(index);
+    segmentHasTick_ = false;
+    return openFile(segment_.path + ".partial");
+}
+
+// Rewrite the manifest through a temporary file
+bool FilePublisher::writeManifest(bool complete) {
+    nlohmann::json segments = nlohmann::json::array();
+    for (const SegmentInfo& segment : segments_) {
+        segments.push_back({
+                {"index", segment.index},
+                {"path", segment.path},
+                {"firstTick", segment.firstTick},
+                {"lastTick", segment.lastTick},
+                {"startTime", segment.startTime},
+                {"endTime", segment.endTime},
+                {"records", segment.records},
+                {"vehicles", segment.vehicles},
+                {"bytes", segment.bytes}
+        });
+    }
+    nlohmann::json manifest = {
+            {"format", format_ == FileFormat::Ndjson ? "ndjson" : "json"},
+            {"complete", complete},
+            {"segments", segments}
     };
-    j["heading"] = vehicle.getHeading();
-    j["speed"] = vehicle.getSpeed();
-    return j.dump();
-}
\ No newline at end of file
+
+    std::string path = manifestPath();
+    std::string temporaryPath = path + ".tmp";
+    {
+        std::ofstream out(temporaryPath, std::ios::out | std::ios::binary | std::ios::trunc);
+        out << manifest.dump(2) << '\n';
+        if (!out) {
+            std::cerr << "Error writing manifest: " << temporaryPath << std::endl;
+            return false;
+        }
+    }
+    if (!syncFile(temporaryPath)) {
+        return false;
+    }
+    if (std::rename(temporaryPath.c_str(), path.c_str()) != 0) {
+        std::cerr << "Error renaming manifest " << temporaryPath << ": " << std::strerror(errno) << std::endl;
+        return false;
+    }
+    return syncParentDirectory(path);
+}
+
+// Insert the segment number before the extension
+std::string FilePublisher::segmentPath(std::uint64_t index) const {
+    char number[32];
+    std::snprintf(number, sizeof(number), "-%06llu", static_cast<unsigned long long>(index));
+    size_t slash = outputFilePath_.find_last_of("/\\");
+    size_t dot = outputFilePath_.find_last_of('.');
+    if (dot == std::string::npos || (slash != std::string::npos && dot < slash)) {
+        return outputFilePath_ + number;
+    }
+    return outputFilePath_.substr(0, dot) + number + outputFilePath_.substr(dot);
+}
+
+// Manifest next to the segments
+std::string FilePublisher::manifestPath() const {
+    size_t slash = outputFilePath_.find_last_of("/\\");
+    size_t dot = outputFilePath_.find_last_of('.');
+    if (dot == std::string::npos || (slash != std::string::npos && dot < slash)) {
+        return outputFilePath_ + ".manifest.json";
+    }
+    return outputFilePath_.substr(0, dot) + ".manifest.json";
+}
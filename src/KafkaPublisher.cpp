@@ -1,96 +1,361 @@
 #include "KafkaPublisher.h"
+#include "KafkaFrame.h"
 #include <iostream>
-#include <nlohmann/json.hpp>
 
-using json = nlohmann::json;
+#ifdef USE_KAFKA
+#include "RdKafkaBackend.h"
+#endif
 
 // Constructor implementation
-KafkaPublisher::KafkaPublisher(const std::string& brokerAddress, const std::string& topicName)
-        : brokerAddress_(brokerAddress), topicName_(topicName) {
+KafkaPublisher::KafkaPublisher(const std::string& brokerAddress, const std::string& topicName,
+                               const KafkaConfig& config)
+        : KafkaPublisher(nullptr, config) {
+#ifdef USE_KAFKA
+    backend_ = std::make_unique<RdKafkaBackend>(brokerAddress, topicName, config);
+    start();
+    if (isReady()) {
+        std::cout << "Kafka publisher initialized successfully." << std::endl;
+    }
+#else
+    (void)topicName;
+    std::cerr << "Cannot connect to Kafka broker " << brokerAddress << ": built without librdkafka" << std::endl;
+#endif
+}
+
+// Constructor with the producer backend
+KafkaPublisher::KafkaPublisher(std::unique_ptr<KafkaProducerBackend> backend, const KafkaConfig& config)
+        : config_(config),
+          freePayloads_(static_cast<size_t>(config.queueMaxMessages > 0 ? config.queueMaxMessages : 1) + 1),
+          produced_(0),
+          delivered_(0),
+          failed_(0),
+          dropped_(0),
+          queueFullRetries_(0),
+          recordsProduced_(0),
+          payloadBytes_(0),
+          latencyNanosTotal_(0),
+          latencyNanosMax_(0),
+          deliveryReporter_(*this),
+          backend_(std::move(backend)),
+          polling_(false),
+          deltaEncoder_(config.keyframeInterval),
+          messagesLost_(false),
+          keyframes_(0),
+          frames_(static_cast<size_t>(config.aggregatePartitions > 0 ? config.aggregatePartitions : 0)),
+          frameTick_(0) {
+    start();
+}
+
+// Destructor
+KafkaPublisher::~KafkaPublisher() {
+    if (isReady()) {
+        finishFrames();
 
-    std::string errstr;
 
-    // Create Kafka configuration
-    conf_.reset(RdKafka::Conf::create(RdKafka::Conf::CONF_GLOBAL));
+        // Allow Kafka to flush any pending messages before destruction
+        backend_->flush(1000);
+    }
 
-    // Set broker address
-    if (conf_->set("bootstrap.servers", brokerAddress_, errstr) != RdKafka::Conf::CONF_OK) {
-        std::cerr << "Error setting Kafka broker address: " << errstr << std::endl;
-        return;
+    polling_.store(false);
+    if (pollThread_.joinable()) {
+        pollThread_.join();
     }
 
-    // Create producer instance
-    producer_.reset(RdKafka::Producer::create(conf_.get(), errstr));
-    if (!producer_) {
-        std::cerr << "Failed to create Kafka producer: " << errstr << std::endl;
-        return;
+    // The producer may still reference pooled payloads until it is gone,
+    // so release it before the pool
+    backend_.reset();
+}
+
+// Publish a dispatcher batch
+bool KafkaPublisher::publish(const PublishBatch& batch) {
+    if (!isReady()) {
+        std::cerr << "Kafka producer not initialized." << std::endl;
+        return false;
+    }
+
+    // JSON messages reuse the batch's shared encoding; delta messages are encoded here
+    bool sharedJson = config_.encoding == KafkaEncoding::Json;
+    bool allProduced = true;
+    for (size_t i = 0; i < batch.count; ++i) {
+        const VehicleRecord& record = batch.records[i];
+        std::string_view json = sharedJson ? batch.jsonAt(i) : std::string_view();
+        allProduced = publishState(record.state, record.tick, record.timestamp, json) && allProduced;
     }
+    return finishFrames() && allProduced;
+}
 
-    // Create topic configuration
-    RdKafka::Conf* tconf = RdKafka::Conf::create(RdKafka::Conf::CONF_TOPIC);
+// Wait for outstanding messages
+bool KafkaPublisher::flush(int timeoutMs) {
+    if (!isReady()) {
+        return false;
+    }
+    return backend_->flush(timeoutMs);
+}
 
-    // Create topic handle
-    topic_.reset(RdKafka::Topic::create(producer_.get(), topicName_, tconf, errstr));
-    delete tconf; // Topic has taken ownership
+// Counters so far
+KafkaPublisherStats KafkaPublisher::getStats() const {
+    KafkaPublisherStats stats;
+    stats.produced = produced_.load(std::memory_order_relaxed);
+    stats.delivered = delivered_.load(std::memory_order_relaxed);
+    stats.failed = failed_.load(std::memory_order_relaxed);
+    stats.dropped = dropped_.load(std::memory_order_relaxed);
+    stats.queueFullRetries = queueFullRetries_.load(std::memory_order_relaxed);
+    stats.records = recordsProduced_.load(std::memory_order_relaxed);
+    stats.payloadBytes = payloadBytes_.load(std::memory_order_relaxed);
+    stats.keyframes = keyframes_.load(std::memory_order_relaxed);
 
-    if (!topic_) {
-        std::cerr << "Failed to create Kafka topic: " << errstr << std::endl;
+    std::uint64_t reported = stats.delivered + stats.failed;
+    if (reported > 0) {
+        stats.averageLatencySeconds = static_cast<double>(latencyNanosTotal_.load(std::memory_order_relaxed))
+                                      / static_cast<double>(reported) * 1e-9;
+    }
+    stats.maxLatencySeconds = static_cast<double>(latencyNanosMax_.load(std::memory_order_relaxed)) * 1e-9;
+
+    std::lock_guard<std::mutex> lock(payloadStorageMutex_);
+    stats.pooledBuffers = payloadStorage_.size();
+    return stats;
+}
+
+// Delivery report: count the outcome and recycle the payload buffer
+void KafkaPublisher::DeliveryReporter::onDelivery(void* opaque, const std::string& error) {
+    auto* payload = static_cast<Payload*>(opaque);
+    if (payload != nullptr) {
+        auto latency = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - payload->producedAt).count();
+        auto nanos = static_cast<std::uint64_t>(latency > 0 ? latency : 0);
+        publisher_.latencyNanosTotal_.fetch_add(nanos, std::memory_order_relaxed);
+        // Only the poll thread updates the maximum
+        if (nanos > publisher_.latencyNanosMax_.load(std::memory_order_relaxed)) {
+            publisher_.latencyNanosMax_.store(nanos, std::memory_order_relaxed);
+        }
+    }
+
+    if (error.empty()) {
+        publisher_.delivered_.fetch_add(1, std::memory_order_relaxed);
+    } else {
+        publisher_.failed_.fetch_add(1, std::memory_order_relaxed);
+        publisher_.messagesLost_.store(true, std::memory_order_relaxed);
+        std::cerr << "Kafka delivery failed: " << error << std::endl;
+    }
+
+    if (payload != nullptr) {
+        publisher_.releasePayload(payload);
+    }
+}
+
+// Attach to the backend and start the poll thread
+void KafkaPublisher::start() {
+    if (!isReady()) {
         return;
     }
 
-    std::cout << "Kafka publisher initialized successfully." << std::endl;
+    // Delivery reports return payload buffers to the pool
+    backend_->setDeliveryListener(&deliveryReporter_);
+
+    // Serve delivery reports off the publishing thread
+    polling_.store(true);
+    pollThread_ = std::thread(&KafkaPublisher::pollLoop, this);
 }
 
-// Destructor
-KafkaPublisher::~KafkaPublisher() {
-    // Allow Kafka to flush any pending messages before destruction
-    if (producer_) {
-        producer_->flush(1000);
+// Serve delivery reports until stopped
+void KafkaPublisher::pollLoop() {
+    while (polling_.load(std::memory_order_relaxed)) {
+        backend_->poll(config_.pollIntervalMs);
     }
+    // Reports that arrived while stopping
+    backend_->poll(0);
 }
 
-// Publish vehicle update
-bool KafkaPublisher::publishVehicleUpdate(const Vehicle& vehicle) {
-    if (!producer_ || !topic_) {
-        std::cerr << "Kafka producer not initialized." << std::endl;
+// Take a free payload buffer
+KafkaPublisher::Payload* KafkaPublisher::acquirePayload() {
+    Payload* payload = nullptr;
+    if (freePayloads_.tryPop(payload)) {
+        return payload;
+    }
+
+    // Never own more buffers than the free list can take back
+    std::lock_guard<std::mutex> lock(payloadStorageMutex_);
+    if (payloadStorage_.size() >= freePayloads_.capacity()) {
+        return nullptr;
+    }
+    payloadStorage_.push_back(std::make_unique<Payload>());
+    return payloadStorage_.back().get();
+}
+
+// Hand a payload buffer back to the pool
+void KafkaPublisher::releasePayload(Payload* payload) {
+    freePayloads_.tryPush(payload); // Cannot fail: the pool never outgrows the ring
+}
+
+// Take a payload buffer, waiting for one to come back if all are in flight
+KafkaPublisher::Payload* KafkaPublisher::waitForPayload(std::chrono::steady_clock::time_point deadline) {
+    Payload* payload = acquirePayload();
+    while (payload == nullptr) {
+        // Every buffer is in flight: wait for delivery reports to return one
+        if (std::chrono::steady_clock::now() >= deadline) {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return nullptr;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        payload = acquirePayload();
+    }
+    return payload;
+}
+
+// Publish one update as its own message or into its partition's frame
+bool KafkaPublisher::publishState(const VehicleState& state, std::uint64_t tick, std::time_t timestamp,
+                                  std::string_view json) {
+    if (config_.aggregatePartitions > 0) {
+        return appendToFrame(state, tick, timestamp, json);
+    }
+
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(config_.queueFullTimeoutMs);
+
+    Payload* payload = waitForPayload(deadline);
+    if (payload == nullptr) {
         return false;
     }
 
-    // Convert vehicle to JSON string
-    std::string payload = vehicleToJson(vehicle);
+    // Serialize into the pooled buffer, keeping its capacity; the batch dies
+    // with the publish call, so already serialized JSON is copied
+    payload->data.clear();
+    if (!json.empty()) {
+        payload->data.append(json.data(), json.size());
+    } else {
+        encodeState(payload->data, state, tick, timestamp);
+    }
+    return producePayload(payload, state.id, KafkaAnyPartition, 1, deadline);
+}
 
-    // Publish message
-    RdKafka::ErrorCode err = producer_->produce(
-            topic_.get(),
-            RdKafka::Topic::PARTITION_UA, // Use builtin partitioner
-            RdKafka::Producer::RK_MSG_COPY, // Copy payload
-            const_cast<char*>(payload.c_str()),
-            payload.size(),
-            vehicle.getId().c_str(),  // Message key = vehicle ID
-            vehicle.getId().size(),
-            nullptr  // Message opaque
-    );
+// Append one update in the configured encoding
+void KafkaPublisher::encodeState(std::string& out, const VehicleState& state, std::uint64_t tick,
+                                 std::time_t timestamp) {
+    if (config_.encoding == KafkaEncoding::Delta) {
+        // A consumer may have missed a message: resync every vehicle with a keyframe
+        if (messagesLost_.exchange(false, std::memory_order_relaxed)) {
+            deltaEncoder_.forceKeyframes();
+        }
+        deltaEncoder_.append(out, state, tick, timestamp);
+        keyframes_.store(deltaEncoder_.getKeyframeCount(), std::memory_order_relaxed);
+    } else {
+        serializer_.append(out, state, timestamp);
+    }
+}
+
+// Add one update to the frame of its partition
+bool KafkaPublisher::appendToFrame(const VehicleState& state, std::uint64_t tick, std::time_t timestamp,
+                                   std::string_view json) {
+    // A frame holds a single tick
+    bool produced = true;
+    if (tick != frameTick_) {
+        produced = finishFrames();
+        frameTick_ = tick;
+    }
 
-    if (err != RdKafka::ERR_NO_ERROR) {
-        std::cerr << "Failed to produce message: " << RdKafka::err2str(err) << std::endl;
+    auto partition = kafkaPartitionOf(state.id, config_.aggregatePartitions);
+    Frame& frame = frames_[static_cast<size_t>(partition)];
+    if (frame.payload == nullptr && frame.dropping) {
         return false;
     }
 
-    // Poll to trigger delivery report callbacks
-    producer_->poll(0);
-    return true;
-}
-
-// Convert vehicle to JSON string
-std::string KafkaPublisher::vehicleToJson(const Vehicle& vehicle) {
-    json j;
-    j["id"] = vehicle.getId();
-    j["timestamp"] = std::time(nullptr);
-    j["position"] = {
-            {"lat", vehicle.getPosition().lat},
-            {"lon", vehicle.getPosition().lon}
-    };
-    j["heading"] = vehicle.getHeading();
-    j["speed"] = vehicle.getSpeed();
-    return j.dump();
-}
\ No newline at end of file
+    // Encode first: whether the update still fits depends on its size
+    std::string_view record = json;
+    if (record.empty()) {
+        frameRecord_.clear();
+        encodeState(frameRecord_, state, tick, timestamp);
+        record = frameRecord_;
+    }
+
+    // Keep frames, index included, within the size limit by sending a full
+    // one early; the next frame goes to the same partition, so ordering is kept
+    if (frame.payload != nullptr
+        && frame.payload->data.size() + record.size() + 4 * (frame.recordEnds.size() + 1)
+           > config_.aggregateMaxBytes) {
+        produced = finishFrame(partition) && produced;
+    }
+
+    if (frame.payload == nullptr) {
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(config_.queueFullTimeoutMs);
+        frame.payload = waitForPayload(deadline);
+        if (frame.payload == nullptr) {
+            // Drop the partition's updates for the rest of the tick rather than wait for each;
+            // a delta encoded update is lost after the encoder counted it, so consumers must resync
+            frame.dropping = true;
+            if (config_.encoding == KafkaEncoding::Delta) {
+                messagesLost_.store(true, std::memory_order_relaxed);
+            }
+            return false;
+        }
+        frame.payload->data.clear();
+        beginKafkaFrame(frame.payload->data, config_.encoding, tick);
+    }
+
+    frame.payload->data.append(record.data(), record.size());
+    frame.recordEnds.push_back(static_cast<std::uint32_t>(frame.payload->data.size()));
+    return produced;
+}
+
+// Produce every frame being filled
+bool KafkaPublisher::finishFrames() {
+    bool allProduced = true;
+    for (size_t partition = 0; partition < frames_.size(); ++partition) {
+        allProduced = finishFrame(static_cast<std::int32_t>(partition)) && allProduced;
+        frames_[partition].dropping = false;
+    }
+    return allProduced;
+}
+
+// Produce the frame of one partition, if it has records
+bool KafkaPublisher::finishFrame(std::int32_t partition) {
+    Frame& frame = frames_[static_cast<size_t>(partition)];
+    if (frame.payload == nullptr) {
+        return true;
+    }
+
+    auto recordCount = static_cast<std::uint32_t>(frame.recordEnds.size());
+    finishKafkaFrame(frame.payload->data, frame.recordEnds.data(), recordCount);
+    Payload* payload = frame.payload;
+    frame.payload = nullptr;
+    frame.recordEnds.clear();
+
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(config_.queueFullTimeoutMs);
+    return producePayload(payload, {}, partition, recordCount, deadline);
+}
+
+// Produce a filled payload buffer
+bool KafkaPublisher::producePayload(Payload* payload, std::string_view key, std::int32_t partition,
+                                    std::uint32_t recordCount, std::chrono::steady_clock::time_point deadline) {
+    payload->producedAt = std::chrono::steady_clock::now();
+    size_t size = payload->data.size(); // The buffer may be recycled as soon as it is produced
+
+    for (;;) {
+        // Publish message; the producer references the buffer until its delivery report
+        std::string error;
+        KafkaProduceStatus status = backend_->produce(std::string_view(payload->data.data(), size), key,
+                                                      partition, payload, error);
+
+        if (status == KafkaProduceStatus::Ok) {
+            produced_.fetch_add(1, std::memory_order_relaxed);
+            recordsProduced_.fetch_add(recordCount, std::memory_order_relaxed);
+            payloadBytes_.fetch_add(size, std::memory_order_relaxed);
+            return true;
+        }
+
+        if (status == KafkaProduceStatus::QueueFull) {
+            // Backpressure: the poll thread drains delivery reports, which frees queue slots
+            queueFullRetries_.fetch_add(1, std::memory_order_relaxed);
+            if (std::chrono::steady_clock::now() < deadline) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                continue;
+            }
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+        } else {
+            std::cerr << "Failed to produce message: " << error << std::endl;
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        messagesLost_.store(true, std::memory_order_relaxed);
+        releasePayload(payload);
+        return false;
+    }
+}
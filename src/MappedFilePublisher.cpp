@@ -0,0 +1,228 @@
+#include "MappedFilePublisher.h"
+#include <cstring>
+#include <iostream>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+// Round up to a multiple of step
+std::uint64_t roundUp(std::uint64_t value, std::uint64_t step) {
+    return (value + step - 1) / step * step;
+}
+
+} // namespace
+
+// Constructor implementation
+MappedFilePublisher::MappedFilePublisher(const std::string& outputFilePath, const MappedFileConfig& config)
+        : outputFilePath_(outputFilePath),
+          config_(config),
+          pageSize_(4096),
+          fd_(-1),
+          allocatedSize_(0),
+          window_(nullptr),
+          windowOffset_(0),
+          windowSize_(0),
+          writeOffset_(0),
+          syncedOffset_(0),
+          recordsWritten_(0),
+          remapCount_(0),
+          syncCount_(0),
+          lastSync_(std::chrono::steady_clock::now()) {
+
+#if defined(_WIN32)
+    std::cerr << "Memory-mapped output is not supported on this platform: " << outputFilePath << std::endl;
+#else
+    long pageSize = ::sysconf(_SC_PAGESIZE);
+    if (pageSize > 0) {
+        pageSize_ = static_cast<size_t>(pageSize);
+    }
+    config_.windowBytes = static_cast<size_t>(roundUp(config_.windowBytes > 0 ? config_.windowBytes : 1, pageSize_));
+    config_.extentBytes = static_cast<size_t>(roundUp(config_.extentBytes > 0 ? config_.extentBytes : 1, pageSize_));
+
+    // Open file for writing
+    fd_ = ::open(outputFilePath.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd_ < 0) {
+        std::cerr << "Error opening output file: " << outputFilePath << std::endl;
+        return;
+    }
+
+    std::cout << "Memory-mapped file publisher initialized successfully." << std::endl;
+#endif
+}
+
+// Destructor
+MappedFilePublisher::~MappedFilePublisher() {
+    close();
+}
+
+// Publish a dispatcher batch
+bool MappedFilePublisher::publish(const PublishBatch& batch) {
+    if (fd_ < 0) {
+        std::cerr << "Output file not opened." << std::endl;
+        return false;
+    }
+
+    for (size_t i = 0; i < batch.count; ++i) {
+        std::string_view json = batch.jsonAt(i);
+        if (!reserve(json.size() + 1)) {
+            return false;
+        }
+        char* out = window_ + (writeOffset_ - windowOffset_);
+        std::memcpy(out, json.data(), json.size());
+        out[json.size()] = '\n';
+        writeOffset_ += json.size() + 1;
+        ++recordsWritten_;
+    }
+    return finishPublish();
+}
+
+// Sync everything written so far
+bool MappedFilePublisher::flush() {
+    return syncWindow(config_.sync.mode);
+}
+
+// Sync, unmap, trim the preallocated tail and close the file
+bool MappedFilePublisher::close() {
+#if defined(_WIN32)
+    return false;
+#else
+    if (fd_ < 0) {
+        return false;
+    }
+
+    bool closed = syncWindow(config_.sync.mode);
+    unmapWindow();
+
+    // Drop the preallocated space past the last record
+    if (::ftruncate(fd_, static_cast<off_t>(writeOffset_)) != 0) {
+        std::cerr << "Error trimming output file: " << outputFilePath_ << std::endl;
+        closed = false;
+    }
+    if (config_.sync.mode == SyncMode::Sync && ::fdatasync(fd_) != 0) {
+        closed = false;
+    }
+    ::close(fd_);
+    fd_ = -1;
+    return closed;
+#endif
+}
+
+// Make room for bytes at the write offset
+bool MappedFilePublisher::reserve(size_t bytes) {
+#if defined(_WIN32)
+    (void)bytes;
+    return false;
+#else
+    if (window_ != nullptr && writeOffset_ + bytes <= windowOffset_ + windowSize_) {
+        return true;
+    }
+
+    // Retire the current window, syncing what it holds
+    if (window_ != nullptr) {
+        syncWindow(config_.sync.mode);
+        unmapWindow();
+    }
+
+    // The new window starts at the page holding the write offset and is
+    // stretched if a single record is larger than a window
+    std::uint64_t offset = writeOffset_ / pageSize_ * pageSize_;
+    size_t size = config_.windowBytes;
+    if (writeOffset_ - offset + bytes > size) {
+        size = static_cast<size_t>(roundUp(writeOffset_ - offset + bytes, pageSize_));
+    }
+    if (!allocate(offset + size)) {
+        return false;
+    }
+
+    void* mapping = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, static_cast<off_t>(offset));
+    if (mapping == MAP_FAILED) {
+        std::cerr << "Error mapping output file: " << outputFilePath_ << std::endl;
+        return false;
+    }
+
+    window_ = static_cast<char*>(mapping);
+    windowOffset_ = offset;
+    windowSize_ = size;
+    ++remapCount_;
+    return true;
+#endif
+}
+
+// Grow the preallocated file to cover end
+bool MappedFilePublisher::allocate(std::uint64_t end) {
+#if defined(_WIN32)
+    (void)end;
+    return false;
+#else
+    if (end <= allocatedSize_) {
+        return true;
+    }
+
+    std::uint64_t size = roundUp(end, config_.extentBytes);
+    int err = ::posix_fallocate(fd_, static_cast<off_t>(allocatedSize_), static_cast<off_t>(size - allocatedSize_));
+    if (err != 0) {
+        std::cerr << "Error preallocating output file " << outputFilePath_ << ": " << std::strerror(err) << std::endl;
+        return false;
+    }
+    allocatedSize_ = size;
+    return true;
+#endif
+}
+
+// Sync the unsynced part of the current window
+bool MappedFilePublisher::syncWindow(SyncMode mode) {
+    lastSync_ = std::chrono::steady_clock::now();
+#if defined(_WIN32)
+    (void)mode;
+    return false;
+#else
+    if (mode == SyncMode::None || window_ == nullptr || syncedOffset_ >= writeOffset_) {
+        return true;
+    }
+
+    // msync needs a page-aligned start; earlier windows were synced when retired
+    std::uint64_t start = syncedOffset_ > windowOffset_ ? syncedOffset_ / pageSize_ * pageSize_ : windowOffset_;
+    int flags = mode == SyncMode::Sync ? MS_SYNC : MS_ASYNC;
+    if (::msync(window_ + (start - windowOffset_), static_cast<size_t>(writeOffset_ - start), flags) != 0) {
+        std::cerr << "Error syncing output file: " << outputFilePath_ << std::endl;
+        return false;
+    }
+    syncedOffset_ = writeOffset_;
+    ++syncCount_;
+    return true;
+#endif
+}
+
+// Sync at the end of a publish call if the policy asks for it
+bool MappedFilePublisher::finishPublish() {
+    const MsyncPolicy& policy = config_.sync;
+    if (policy.mode == SyncMode::None || syncedOffset_ >= writeOffset_) {
+        return true;
+    }
+    if (policy.everyPublish || (policy.bytes > 0 && writeOffset_ - syncedOffset_ >= policy.bytes)) {
+        return syncWindow(policy.mode);
+    }
+    if (policy.intervalSeconds > 0.0) {
+        std::chrono::duration<double> sinceSync = std::chrono::steady_clock::now() - lastSync_;
+        if (sinceSync.count() >= policy.intervalSeconds) {
+            return syncWindow(policy.mode);
+        }
+    }
+    return true;
+}
+
+// Unmap the current window
+void MappedFilePublisher::unmapWindow() {
+#if !defined(_WIN32)
+    if (window_ != nullptr) {
+        ::munmap(window_, windowSize_);
+    }
+#endif
+    window_ = nullptr;
+    windowSize_ = 0;
+}
@@ -0,0 +1,171 @@
+#include "MockKafkaBackend.h"
+#include <algorithm>
+#include <vector>
+
+namespace {
+
+// FNV-1a over the payload bytes
+std::uint64_t checksum(std::string_view data) {
+    std::uint64_t hash = 14695981039346656037ull;
+    for (char c : data) {
+        hash = (hash ^ static_cast<unsigned char>(c)) * 1099511628211ull;
+    }
+    return hash;
+}
+
+// Longest flush waits inside one poll, so it notices reports served elsewhere
+constexpr int FlushSliceMs = 10;
+
+} // namespace
+
+// Constructor with the simulated broker behaviour
+MockKafkaBackend::MockKafkaBackend(const MockKafkaConfig& config)
+        : config_(config),
+          listener_(nullptr),
+          reporting_(0),
+          linkFree_(Clock::now()),
+          lastDue_(Clock::now()),
+          rng_(config.seed),
+          corruptPayloads_(0) {}
+
+// Set the receiver of delivery reports
+void MockKafkaBackend::setDeliveryListener(KafkaDeliveryListener* listener) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    listener_ = listener;
+}
+
+// Queue one message behind the link
+KafkaProduceStatus MockKafkaBackend::produce(std::string_view payload, std::string_view key, std::int32_t partition,
+                                             void* opaque, std::string& error) {
+    (void)key;
+    (void)partition;
+    (void)error;
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (queue_.size() + reporting_ >= config_.queueMaxMessages) {
+        ++stats_.rejected;
+        return KafkaProduceStatus::QueueFull;
+    }
+
+    // Transmission starts when the link is free and takes size / bandwidth
+    Clock::time_point now = Clock::now();
+    Clock::time_point sent = std::max(now, linkFree_);
+    if (config_.bytesPerSecond > 0.0) {
+        sent += std::chrono::duration_cast<Clock::duration>(
+                std::chrono::duration<double>(static_cast<double>(payload.size()) / config_.bytesPerSecond));
+    }
+    linkFree_ = sent;
+
+    double latencyMs = config_.ackLatencyMs;
+    if (config_.ackJitterMs > 0.0) {
+        latencyMs += std::uniform_real_distribution<double>(0.0, config_.ackJitterMs)(rng_);
+    }
+    // Reports keep produce order, as within a partition
+    Clock::time_point due = std::max(lastDue_, sent + std::chrono::duration_cast<Clock::duration>(
+            std::chrono::duration<double, std::milli>(latencyMs)));
+    lastDue_ = due;
+
+    bool fail = config_.failureRate > 0.0
+                && std::uniform_real_distribution<double>(0.0, 1.0)(rng_) < config_.failureRate;
+
+    queue_.push_back({payload, config_.verifyPayloads ? checksum(payload) : 0, opaque, due, fail});
+    ++stats_.accepted;
+    stats_.maxQueued = std::max(stats_.maxQueued, queue_.size());
+    stats_.maxMessageBytes = std::max(stats_.maxMessageBytes, payload.size());
+    changed_.notify_all();
+    return KafkaProduceStatus::Ok;
+}
+
+// Serve delivery reports, waiting up to timeoutMs for the next one to fall due
+void MockKafkaBackend::poll(int timeoutMs) {
+    Clock::time_point deadline = Clock::now() + std::chrono::milliseconds(timeoutMs);
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        for (;;) {
+            Clock::time_point now = Clock::now();
+            if (!queue_.empty() && queue_.front().due <= now) {
+                break;
+            }
+            if (now >= deadline) {
+                return;
+            }
+            // Sleep until the first report is due, or until produce adds one
+            Clock::time_point wakeAt = queue_.empty() ? deadline : std::min(deadline, queue_.front().due);
+            changed_.wait_until(lock, wakeAt);
+        }
+    }
+    deliverDue();
+}
+
+// Poll until every queued message has been reported
+bool MockKafkaBackend::flush(int timeoutMs) {
+    Clock::time_point deadline = Clock::now() + std::chrono::milliseconds(timeoutMs);
+    for (;;) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (queue_.empty() && reporting_ == 0) {
+                return true;
+            }
+        }
+        auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - Clock::now()).count();
+        if (remaining <= 0) {
+            return false;
+        }
+        if (remaining > FlushSliceMs) {
+            remaining = FlushSliceMs;
+        }
+        poll(static_cast<int>(remaining));
+    }
+}
+
+// Counters so far
+MockKafkaStats MockKafkaBackend::getStats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+// Delivery reports whose payload changed in flight
+std::uint64_t MockKafkaBackend::getCorruptPayloads() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return corruptPayloads_;
+}
+
+// Serve the reports due by now
+size_t MockKafkaBackend::deliverDue() {
+    std::vector<Message> due;
+    KafkaDeliveryListener* listener;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        Clock::time_point now = Clock::now();
+        while (!queue_.empty() && queue_.front().due <= now) {
+            const Message& message = queue_.front();
+            if (config_.verifyPayloads && checksum(message.payload) != message.checksum) {
+                ++corruptPayloads_;
+            }
+            if (message.fail) {
+                ++stats_.failed;
+            } else {
+                ++stats_.delivered;
+                stats_.bytesDelivered += message.payload.size();
+            }
+            due.push_back(message);
+            queue_.pop_front();
+        }
+        reporting_ += due.size();
+        listener = listener_;
+    }
+
+    // Reports run unlocked: the listener may recycle payloads or produce again
+    static const std::string noError;
+    static const std::string injectedError = "Injected delivery failure";
+    if (listener != nullptr) {
+        for (const Message& message : due) {
+            listener->onDelivery(message.opaque, message.fail ? injectedError : noError);
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        reporting_ -= due.size();
+    }
+    return due.size();
+}
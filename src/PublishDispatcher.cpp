@@ -0,0 +1,178 @@
+#include "PublishDispatcher.h"
+#include <chrono>
+
+// Destructor drains every queue and joins the sink threads
+PublishDispatcher::~PublishDispatcher() {
+    for (const auto& sink : sinks_) {
+        {
+            std::lock_guard<std::mutex> lock(sink->mutex);
+            sink->stopping = true;
+        }
+        sink->workAvailable.notify_one();
+    }
+    for (const auto& sink : sinks_) {
+        sink->worker.join();
+        sink->publisher->flush();
+    }
+}
+
+// Add a sink and start its thread
+void PublishDispatcher::addSink(const std::string& name, Publisher& sink, const SinkPolicy& policy) {
+    auto entry = std::make_unique<Sink>();
+    entry->name = name;
+    entry->publisher = &sink;
+    entry->policy = policy;
+    if (entry->policy.queueDepth == 0) {
+        entry->policy.queueDepth = 1;
+    }
+    if (entry->policy.sampleEvery == 0) {
+        entry->policy.sampleEvery = 1;
+    }
+    entry->stats.name = name;
+
+    if (sink.getPayloadFormat() == PayloadFormat::Json) {
+        needsJson_ = true;
+    }
+
+    Sink& added = *entry;
+    sinks_.push_back(std::move(entry));
+    added.worker = std::thread(&PublishDispatcher::drainLoop, std::ref(added));
+}
+
+// Encode a tick and queue it to every sink
+void PublishDispatcher::publishTick(const TickSnapshot& snapshot) {
+    if (sinks_.empty()) {
+        return;
+    }
+
+    // Copy the states out of the snapshot, which dies with the callback
+    auto batch = std::make_shared<Batch>();
+    batch->info = snapshot.info;
+    batch->records.reserve(snapshot.size());
+    for (const VehicleState& state : snapshot) {
+        batch->records.push_back({state, snapshot.info.tick, snapshot.info.timestamp});
+    }
+
+    // One serialization pass shared by every JSON sink
+    if (needsJson_) {
+        batch->json.reserve(lastJsonSize_ + VehicleJsonSerializer::MaxRecordOverhead);
+        batch->jsonOffsets.reserve(snapshot.size() + 1);
+        batch->jsonOffsets.push_back(0);
+        for (const VehicleState& state : snapshot) {
+            serializer_.append(batch->json, state, snapshot.info.timestamp);
+            batch->jsonOffsets.push_back(static_cast<std::uint32_t>(batch->json.size()));
+        }
+        lastJsonSize_ = batch->json.size();
+    }
+
+    std::shared_ptr<const Batch> shared = std::move(batch);
+    for (const auto& sink : sinks_) {
+        std::shared_ptr<const Batch> dropped = enqueue(*sink, shared);
+        if (dropped && dropCallback_) {
+            dropCallback_(sink->name, dropped->info, dropped->records);
+        }
+    }
+}
+
+// Wait until every queued tick has been published, then flush the sinks
+void PublishDispatcher::flush() {
+    for (const auto& sink : sinks_) {
+        std::unique_lock<std::mutex> lock(sink->mutex);
+        sink->spaceAvailable.wait(lock, [&sink] {
+            return sink->queue.empty() && !sink->busy;
+        });
+        // Holding the lock keeps the sink thread out of publish() meanwhile
+        sink->publisher->flush();
+    }
+}
+
+// Counters so far
+std::vector<SinkStats> PublishDispatcher::getStats() const {
+    std::vector<SinkStats> stats;
+    stats.reserve(sinks_.size());
+    for (const auto& sink : sinks_) {
+        std::lock_guard<std::mutex> lock(sink->mutex);
+        stats.push_back(sink->stats);
+        stats.back().queueDepth = sink->queue.size();
+    }
+    return stats;
+}
+
+// Queue a batch to one sink according to its policy
+std::shared_ptr<const PublishDispatcher::Batch> PublishDispatcher::enqueue(
+        Sink& sink, const std::shared_ptr<const Batch>& batch) {
+    std::unique_lock<std::mutex> lock(sink.mutex);
+    const SinkPolicy& policy = sink.policy;
+    ++sink.stats.ticksOffered;
+    std::shared_ptr<const Batch> dropped;
+
+    switch (policy.backpressure) {
+        case BackpressurePolicy::Block:
+            if (sink.queue.size() >= policy.queueDepth) {
+                auto start = std::chrono::steady_clock::now();
+                sink.spaceAvailable.wait(lock, [&sink, &policy] {
+                    return sink.queue.size() < policy.queueDepth;
+                });
+                sink.stats.blockedSeconds += std::chrono::duration<double>(
+                        std::chrono::steady_clock::now() - start).count();
+            }
+            break;
+
+        case BackpressurePolicy::DropOldest:
+            if (sink.queue.size() >= policy.queueDepth) {
+                dropped = std::move(sink.queue.front());
+                sink.queue.pop_front();
+                ++sink.stats.ticksDropped;
+            }
+            break;
+
+        case BackpressurePolicy::Sample:
+            if (sink.queue.size() >= policy.queueDepth
+                || (sink.queue.size() * 2 >= policy.queueDepth && sink.stats.ticksOffered % policy.sampleEvery != 0)) {
+                ++sink.stats.ticksDropped;
+                return batch;
+            }
+            break;
+    }
+
+    sink.queue.push_back(batch);
+    ++sink.stats.ticksQueued;
+    if (sink.queue.size() > sink.stats.highWaterMark) {
+        sink.stats.highWaterMark = sink.queue.size();
+    }
+    lock.unlock();
+    sink.workAvailable.notify_one();
+    return dropped;
+}
+
+// Sink thread main loop
+void PublishDispatcher::drainLoop(Sink& sink) {
+    std::unique_lock<std::mutex> lock(sink.mutex);
+    for (;;) {
+        sink.workAvailable.wait(lock, [&sink] {
+            return !sink.queue.empty() || sink.stopping;
+        });
+        if (sink.queue.empty()) {
+            return; // Stopping with nothing left to publish
+        }
+
+        std::shared_ptr<const Batch> batch = std::move(sink.queue.front());
+        sink.queue.pop_front();
+        sink.busy = true;
+        lock.unlock();
+        sink.spaceAvailable.notify_all();
+
+        PublishBatch view{batch->info, batch->records.data(), batch->records.size(),
+                          batch->json, batch->jsonOffsets.data()};
+        sink.publisher->publish(view);
+        batch.reset();
+
+        lock.lock();
+        sink.busy = false;
+        ++sink.stats.ticksPublished;
+        sink.stats.recordsPublished += view.count;
+        if (sink.queue.empty()) {
+            sink.spaceAvailable.notify_all();
+        }
+    }
+}
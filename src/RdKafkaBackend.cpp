@@ -0,0 +1,128 @@
+#include "RdKafkaBackend.h"
+#include <iostream>
+
+// Constructor implementation
+RdKafkaBackend::RdKafkaBackend(const std::string& brokerAddress, const std::string& topicName,
+                               const KafkaConfig& config)
+        : brokerAddress_(brokerAddress),
+          topicName_(topicName) {
+
+    std::string errstr;
+
+    // Create Kafka configuration
+    conf_.reset(RdKafka::Conf::create(RdKafka::Conf::CONF_GLOBAL));
+
+    // Set broker address
+    if (!setProperty("bootstrap.servers", brokerAddress_)) {
+        return;
+    }
+
+    // Batching, compression and delivery guarantees
+    if (!setProperty("linger.ms", std::to_string(config.lingerMs))
+        || !setProperty("batch.size", std::to_string(config.batchBytes))
+        || !setProperty("compression.codec", config.compression)
+        || !setProperty("queue.buffering.max.messages", std::to_string(config.queueMaxMessages))
+        || !setProperty("acks", config.acks)) {
+        return;
+    }
+
+    // Deltas build on the previous message of their vehicle, and a vehicle's
+    // frames must stay in tick order, so retries must not reorder a partition
+    if (config.encoding == KafkaEncoding::Delta || config.aggregatePartitions > 0) {
+        bool ordered = config.acks == "all" || config.acks == "-1"
+                       ? setProperty("enable.idempotence", "true")
+                       : setProperty("max.in.flight.requests.per.connection", "1");
+        if (!ordered) {
+            return;
+        }
+    }
+
+    // Delivery reports go to the listener
+    if (conf_->set("dr_cb", &deliveryReporter_, errstr) != RdKafka::Conf::CONF_OK) {
+        std::cerr << "Error setting Kafka delivery report callback: " << errstr << std::endl;
+        return;
+    }
+
+    // Create producer instance
+    producer_.reset(RdKafka::Producer::create(conf_.get(), errstr));
+    if (!producer_) {
+        std::cerr << "Failed to create Kafka producer: " << errstr << std::endl;
+        return;
+    }
+
+    // Create topic configuration
+    RdKafka::Conf* tconf = RdKafka::Conf::create(RdKafka::Conf::CONF_TOPIC);
+
+    // Create topic handle
+    topic_.reset(RdKafka::Topic::create(producer_.get(), topicName_, tconf, errstr));
+    delete tconf; // Topic has taken ownership
+
+    if (!topic_) {
+        std::cerr << "Failed to create Kafka topic: " << errstr << std::endl;
+        producer_.reset();
+    }
+}
+
+// Destructor
+RdKafkaBackend::~RdKafkaBackend() {
+    topic_.reset();
+    producer_.reset();
+}
+
+// Queue one message
+KafkaProduceStatus RdKafkaBackend::produce(std::string_view payload, std::string_view key, std::int32_t partition,
+                                           void* opaque, std::string& error) {
+    // librdkafka references the payload until its delivery report
+    RdKafka::ErrorCode err = producer_->produce(
+            topic_.get(),
+            partition == KafkaAnyPartition ? RdKafka::Topic::PARTITION_UA : partition, // UA: builtin partitioner
+            0, // Neither copy nor free the payload
+            const_cast<char*>(payload.data()),
+            payload.size(),
+            key.data(),
+            key.size(),
+            opaque  // Message opaque, handed back in the delivery report
+    );
+
+    if (err == RdKafka::ERR_NO_ERROR) {
+        return KafkaProduceStatus::Ok;
+    }
+    if (err == RdKafka::ERR__QUEUE_FULL) {
+        return KafkaProduceStatus::QueueFull;
+    }
+    error = RdKafka::err2str(err);
+    return KafkaProduceStatus::Error;
+}
+
+// Serve delivery reports
+void RdKafkaBackend::poll(int timeoutMs) {
+    producer_->poll(timeoutMs);
+}
+
+// Wait for outstanding messages
+bool RdKafkaBackend::flush(int timeoutMs) {
+    return producer_->flush(timeoutMs) == RdKafka::ERR_NO_ERROR;
+}
+
+// Delivery report: hand the outcome to the listener
+void RdKafkaBackend::DeliveryReporter::dr_cb(RdKafka::Message& message) {
+    if (listener == nullptr) {
+        return;
+    }
+    static const std::string noError;
+    if (message.err() == RdKafka::ERR_NO_ERROR) {
+        listener->onDelivery(message.msg_opaque(), noError);
+    } else {
+        listener->onDelivery(message.msg_opaque(), message.errstr());
+    }
+}
+
+// Set one producer property
+bool RdKafkaBackend::setProperty(const std::string& name, const std::string& value) {
+    std::string errstr;
+    if (conf_->set(name, value, errstr) != RdKafka::Conf::CONF_OK) {
+        std::cerr << "Error setting Kafka property " << name << "=" << value << ": " << errstr << std::endl;
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,245 @@
+#include "Route.h"
+#include <algorithm>
+#include <limits>
+
+namespace {
+
+// Routes with fewer segments than this are scanned linearly
+constexpr size_t MinIndexedSegments = 32;
+
+} // namespace
+
+// Closest point on one segment
+RouteSnap RouteGeometry::snapToSegment(const LocalPoint& position, size_t segment) const {
+    const LocalPoint& start = points_[segment];
+    const RouteSegment& data = segments_[segment];
+
+    // Project onto the segment and clamp to its end points
+    double fraction = 0.0;
+    double lengthSquared = data.length * data.length;
+    if (lengthSquared > 0.0) {
+        fraction = ((position.x - start.x) * data.dx + (position.y - start.y) * data.dy) / lengthSquared;
+        fraction = std::max(0.0, std::min(1.0, fraction));
+    }
+
+    LocalPoint point{start.x + fraction * data.dx, start.y + fraction * data.dy};
+    return {point, position.distanceTo(point), segment, fraction};
+}
+
+// Get the segment grid, building it on first use
+const SegmentGrid& RouteGeometry::segmentGrid() const {
+    if (const SegmentGrid* grid = index_.load(std::memory_order_acquire)) {
+        return *grid;
+    }
+
+    std::lock_guard<std::mutex> lock(gridMutex_);
+    if (grid_) {
+        return *grid_;
+    }
+
+    auto grid = std::make_unique<SegmentGrid>();
+
+    // Bounding box of the whole route
+    double minX = points_.front().x;
+    double maxX = minX;
+    double minY = points_.front().y;
+    double maxY = minY;
+    for (const LocalPoint& point : points_) {
+        minX = std::min(minX, point.x);
+        maxX = std::max(maxX, point.x);
+        minY = std::min(minY, point.y);
+        maxY = std::max(maxY, point.y);
+    }
+
+    // Square cells, roughly one per segment. A nearly flat box would give
+    // tiny cells and a huge grid, so cells are never smaller than the
+    // longer side split into one cell per segment; that keeps the cell
+    // count linear in the segment count.
+    double extentX = maxX - minX;
+    double extentY = maxY - minY;
+    double segmentCount = static_cast<double>(segments_.size());
+    double cellSize = std::max(std::sqrt(extentX * extentY / segmentCount),
+                               std::max(extentX, extentY) / segmentCount);
+    if (!(cellSize > 0.0)) {
+        cellSize = 1.0;
+    }
+
+    grid->minX = minX;
+    grid->minY = minY;
+    grid->cellSize = cellSize;
+    grid->rows = static_cast<size_t>(extentY / cellSize) + 1;
+    grid->cols = static_cast<size_t>(extentX / cellSize) + 1;
+
+    // Cell range covered by a segment's bounding box
+    auto cellRange = [&](size_t segment, size_t& row0, size_t& row1, size_t& col0, size_t& col1) {
+        const LocalPoint& a = points_[segment];
+        const LocalPoint& b = points_[segment + 1];
+        row0 = std::min(grid->rows - 1, static_cast<size_t>((std::min(a.y, b.y) - minY) / cellSize));
+        row1 = std::min(grid->rows - 1, static_cast<size_t>((std::max(a.y, b.y) - minY) / cellSize));
+        col0 = std::min(grid->cols - 1, static_cast<size_t>((std::min(a.x, b.x) - minX) / cellSize));
+        col1 = std::min(grid->cols - 1, static_cast<size_t>((std::max(a.x, b.x) - minX) / cellSize));
+    };
+
+    // Two passes: count per cell, then fill
+    size_t cellCount = grid->rows * grid->cols;
+    grid->cellStart.assign(cellCount + 1, 0);
+    for (size_t segment = 0; segment < segments_.size(); ++segment) {
+        size_t row0, row1, col0, col1;
+        cellRange(segment, row0, row1, col0, col1);
+        for (size_t row = row0; row <= row1; ++row) {
+            for (size_t col = col0; col <= col1; ++col) {
+                grid->cellStart[row * grid->cols + col + 1]++;
+            }
+        }
+    }
+    for (size_t cell = 0; cell < cellCount; ++cell) {
+        grid->cellStart[cell + 1] += grid->cellStart[cell];
+    }
+
+    grid->cellSegments.resize(grid->cellStart[cellCount]);
+    std::vector<std::uint32_t> fill(grid->cellStart.begin(), grid->cellStart.end() - 1);
+    for (size_t segment = 0; segment < segments_.size(); ++segment) {
+        size_t row0, row1, col0, col1;
+        cellRange(segment, row0, row1, col0, col1);
+        for (size_t row = row0; row <= row1; ++row) {
+            for (size_t col = col0; col <= col1; ++col) {
+                grid->cellSegments[fill[row * grid->cols + col]++] = static_cast<std::uint32_t>(segment);
+            }
+        }
+    }
+
+    grid_ = std::move(grid);
+    index_.store(grid_.get(), std::memory_order_release);
+    return *grid_;
+}
+
+// Closest point on the route to a position
+RouteSnap RouteGeometry::closestPoint(const LocalPoint& position) const {
+    if (points_.empty()) {
+        return {{0.0, 0.0}, std::numeric_limits<double>::infinity(), 0, 0.0};
+    }
+    // Nothing is closest to a non-finite position, and the grid search
+    // below could not bound it; report the first waypoint
+    if (segments_.empty() || !std::isfinite(position.x) || !std::isfinite(position.y)) {
+        return {points_.front(), position.distanceTo(points_.front()), 0, 0.0};
+    }
+
+    RouteSnap best{{0.0, 0.0}, std::numeric_limits<double>::infinity(), 0, 0.0};
+    auto consider = [&](size_t segment) {
+        RouteSnap snap = snapToSegment(position, segment);
+        // Prefer the earliest segment on ties so results do not depend on visit order
+        if (snap.distance < best.distance || (snap.distance == best.distance && segment < best.segment)) {
+            best = snap;
+        }
+    };
+
+    // Short routes: scan every segment
+    if (segments_.size() < MinIndexedSegments) {
+        for (size_t segment = 0; segment < segments_.size(); ++segment) {
+            consider(segment);
+        }
+        return best;
+    }
+
+    // Long routes: search rings of grid cells outwards from the position's
+    // cell until no unsearched cell can hold anything closer
+    const SegmentGrid& grid = segmentGrid();
+    auto clampCell = [](double offset, double cellSize, size_t count) {
+        double cell = std::floor(offset / cellSize);
+        if (!(cell > 0.0)) {
+            return static_cast<long>(0);
+        }
+        return static_cast<long>(std::min(cell, static_cast<double>(count - 1)));
+    };
+    long centerRow = clampCell(position.y - grid.minY, grid.cellSize, grid.rows);
+    long centerCol = clampCell(position.x - grid.minX, grid.cellSize, grid.cols);
+    long rows = static_cast<long>(grid.rows);
+    long cols = static_cast<long>(grid.cols);
+
+    for (long ring = 0;; ++ring) {
+        long row0 = std::max(0L, centerRow - ring);
+        long row1 = std::min(rows - 1, centerRow + ring);
+        long col0 = std::max(0L, centerCol - ring);
+        long col1 = std::min(cols - 1, centerCol + ring);
+
+        // Only the cells on the ring's border are new
+        for (long row = row0; row <= row1; ++row) {
+            bool borderRow = row == centerRow - ring || row == centerRow + ring;
+            long step = borderRow ? 1 : std::max(1L, 2 * ring);
+            for (long col = centerCol - ring; col <= centerCol + ring; col += step) {
+                if (col < col0 || col > col1) {
+                    continue;
+                }
+                size_t cell = static_cast<size_t>(row * cols + col);
+                for (std::uint32_t i = grid.cellStart[cell]; i < grid.cellStart[cell + 1]; ++i) {
+                    consider(grid.cellSegments[i]);
+                }
+            }
+        }
+
+        // Distance from the position to the nearest cell outside the searched block
+        double bound = std::numeric_limits<double>::infinity();
+        if (row0 > 0) {
+            bound = std::min(bound, std::max(0.0, position.y - (grid.minY + row0 * grid.cellSize)));
+        }
+        if (row1 < rows - 1) {
+            bound = std::min(bound, std::max(0.0, grid.minY + (row1 + 1) * grid.cellSize - position.y));
+        }
+        if (col0 > 0) {
+            bound = std::min(bound, std::max(0.0, position.x - (grid.minX + col0 * grid.cellSize)));
+        }
+        if (col1 < cols - 1) {
+            bound = std::min(bound, std::max(0.0, grid.minX + (col1 + 1) * grid.cellSize - position.x));
+        }
+        // An infinite bound means the whole grid has been searched
+        if (best.distance <= bound || bound == std::numeric_limits<double>::infinity()) {
+            return best;
+        }
+    }
+}
+
+// Point at the given distance along the route
+LocalPoint RouteGeometry::pointAtDistance(double distance) const {
+    if (points_.empty()) {
+        return projection_.toLocal({0.0, 0.0});
+    }
+    if (!(distance > 0.0)) {
+        return points_.front();
+    }
+    if (distance >= getTotalDistance()) {
+        return points_.back();
+    }
+
+    // First waypoint beyond the distance ends the segment containing it
+    auto after = std::upper_bound(cumulativeDistance_.begin(), cumulativeDistance_.end(), distance);
+    size_t segment = static_cast<size_t>(after - cumulativeDistance_.begin()) - 1;
+
+    const RouteSegment& data = segments_[segment];
+    double fraction = data.length > 0.0 ? (distance - cumulativeDistance_[segment]) / data.length : 0.0;
+    const LocalPoint& start = points_[segment];
+    return {start.x + fraction * data.dx, start.y + fraction * data.dy};
+}
+
+// Get closest point on the route to a given position
+std::pair<GeoPoint, double> Route::getClosestPointOnRoute(const GeoPoint& position) const {
+    const LocalProjection& projection = geometry_->getProjection();
+    RouteSnap snap = geometry_->closestPoint(projection.toLocal(position));
+    return {projection.toGeo(snap.point), snap.distance};
+}
+
+// Snap many positions onto the route in one call
+std::vector<std::pair<GeoPoint, double>> Route::getClosestPointOnRoute(const std::vector<GeoPoint>& positions) const {
+    std::vector<std::pair<GeoPoint, double>> results;
+    results.reserve(positions.size());
+    const LocalProjection& projection = geometry_->getProjection();
+    for (const GeoPoint& position : positions) {
+        RouteSnap snap = geometry_->closestPoint(projection.toLocal(position));
+        results.emplace_back(projection.toGeo(snap.point), snap.distance);
+    }
+    return results;
+}
+
+// Get total route distance
+double Route::getTotalDistance() const {
+    return geometry_->getTotalDistance();
+}
@@ -0,0 +1,77 @@
+#include "SimulationClock.h"
+#include <algorithm>
+#include <thread>
+
+// Constructor with the simulation time step and the real-time factor
+SimulationClock::SimulationClock(double timeStep, double realTimeFactor)
+        : timeStep_(timeStep),
+          realTimeFactor_(realTimeFactor),
+          maxLagSeconds_(1.0),
+          epochTick_(0) {
+    start();
+}
+
+// Set the real-time factor; takes effect from the next tick
+void SimulationClock::setRealTimeFactor(double realTimeFactor) {
+    realTimeFactor_ = realTimeFactor;
+
+    // Re-anchor so ticks already paced keep their old spacing
+    epoch_ = Clock::now();
+    epochTick_ = stats_.ticks;
+}
+
+// Anchor the schedule at the current time and reset the counters
+void SimulationClock::start() {
+    stats_ = ClockStats();
+    started_ = Clock::now();
+    epoch_ = started_;
+    epochTick_ = 0;
+    tickBegin_ = started_;
+}
+
+// Mark the start of a tick's work
+void SimulationClock::beginTick() {
+    tickBegin_ = Clock::now();
+}
+
+// Mark the end of a tick's work and wait until the next tick is due
+void SimulationClock::endTick() {
+    Clock::time_point now = Clock::now();
+    double tickSeconds = std::chrono::duration<double>(now - tickBegin_).count();
+    stats_.totalTickSeconds += tickSeconds;
+    stats_.maxTickSeconds = std::max(stats_.maxTickSeconds, tickSeconds);
+    stats_.simulationSeconds += timeStep_;
+    ++stats_.ticks;
+
+    if (isThrottled()) {
+        Clock::time_point due = deadline(stats_.ticks);
+        if (now > due) {
+            double overrun = std::chrono::duration<double>(now - due).count();
+            ++stats_.overruns;
+            stats_.totalOverrunSeconds += overrun;
+            stats_.maxOverrunSeconds = std::max(stats_.maxOverrunSeconds, overrun);
+
+            // Too far behind to catch up: start a new schedule from here
+            if (overrun > maxLagSeconds_) {
+                epoch_ = now;
+                epochTick_ = stats_.ticks;
+                ++stats_.resyncs;
+            }
+        } else {
+            std::this_thread::sleep_until(due);
+        }
+    }
+
+    stats_.wallSeconds = std::chrono::duration<double>(Clock::now() - started_).count();
+}
+
+// Counters so far
+ClockStats SimulationClock::getStats() const {
+    return stats_;
+}
+
+// Wall-clock deadline of the given tick
+SimulationClock::Clock::time_point SimulationClock::deadline(std::uint64_t tick) const {
+    double seconds = static_cast<double>(tick - epochTick_) * timeStep_ / realTimeFactor_;
+    return epoch_ + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(seconds));
+}
@@ -0,0 +1,109 @@
+#include "SnapshotPipeline.h"
+#include <chrono>
+#include <utility>
+
+// Constructor implementation
+SnapshotPipeline::SnapshotPipeline(LagPolicy policy)
+        : policy_(policy),
+          back_(0),
+          pending_(1),
+          front_(2),
+          hasPending_(false),
+          consuming_(false),
+          stopping_(false) {
+    consumer_ = std::thread(&SnapshotPipeline::consumeLoop, this);
+}
+
+// Destructor
+SnapshotPipeline::~SnapshotPipeline() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    pendingCondition_.notify_all();
+    consumer_.join();
+}
+
+// Register a consumer
+void SnapshotPipeline::addConsumer(TickCallback consumer) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    consumers_.push_back(std::move(consumer));
+}
+
+// Hand the back buffer over to the consumers
+void SnapshotPipeline::publish(const TickInfo& info) {
+    buffers_[back_].info = info;
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    ++stats_.ticksPublished;
+
+    if (hasPending_) {
+        // Consumers are still on an older tick and the previous one is waiting
+        switch (policy_) {
+            case LagPolicy::Block: {
+                auto start = std::chrono::steady_clock::now();
+                consumedCondition_.wait(lock, [this] { return !hasPending_; });
+                stats_.blockedSeconds += std::chrono::duration<double>(
+                        std::chrono::steady_clock::now() - start).count();
+                break;
+            }
+            case LagPolicy::Drop:
+                // Keep the pending tick; the back buffer is simply refilled next tick
+                ++stats_.ticksDropped;
+                return;
+            case LagPolicy::Coalesce:
+                // The newer tick replaces the pending one below
+                ++stats_.ticksCoalesced;
+                break;
+        }
+    }
+
+    std::swap(back_, pending_);
+    hasPending_ = true;
+    lock.unlock();
+    pendingCondition_.notify_one();
+}
+
+// Wait until every published tick has been consumed or dropped
+void SnapshotPipeline::waitIdle() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    consumedCondition_.wait(lock, [this] { return !hasPending_ && !consuming_; });
+}
+
+// Counters so far
+PipelineStats SnapshotPipeline::getStats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+// Consumer thread main loop
+void SnapshotPipeline::consumeLoop() {
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    while (true) {
+        pendingCondition_.wait(lock, [this] { return stopping_ || hasPending_; });
+        if (!hasPending_) {
+            // Stopping with nothing left to deliver
+            return;
+        }
+
+        // Take the pending tick; the simulation may now publish into the old front
+        std::swap(pending_, front_);
+        hasPending_ = false;
+        consuming_ = true;
+        consumedCondition_.notify_all();
+
+        const Buffer& buffer = buffers_[front_];
+        TickSnapshot snapshot{buffer.info, buffer.states.data(), buffer.states.size()};
+        lock.unlock();
+
+        for (const auto& consumer : consumers_) {
+            consumer(snapshot);
+        }
+
+        lock.lock();
+        consuming_ = false;
+        ++stats_.ticksDelivered;
+        consumedCondition_.notify_all();
+    }
+}
@@ -0,0 +1,205 @@
+#include "TelemetryReader.h"
+#include <iostream>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Constructor with the file to map
+TelemetryReader::TelemetryReader(const std::string& path)
+        : path_(path),
+          data_(nullptr),
+          fileSize_(0),
+          records_(nullptr),
+          recordCount_(0)
+#if defined(_WIN32)
+          , fileHandle_(nullptr),
+          mappingHandle_(nullptr)
+#endif
+{
+    if (!map()) {
+        return;
+    }
+
+    if (fileSize_ < TelemetryHeaderSize || !decodeTelemetryHeader(data_, header_)) {
+        std::cerr << "Not a telemetry file: " << path_ << std::endl;
+        unmap();
+        return;
+    }
+    if (header_.version != TelemetryVersion || header_.recordSize != TelemetryRecordSize
+        || header_.headerSize < TelemetryHeaderSize || header_.headerSize > fileSize_) {
+        std::cerr << "Unsupported telemetry format version " << header_.version
+                  << " in " << path_ << std::endl;
+        unmap();
+        return;
+    }
+
+    records_ = data_ + header_.headerSize;
+
+    if (isComplete()) {
+        // Records must fit between the header and the dictionary, both inside the mapping
+        std::uint64_t offset = header_.dictionaryOffset;
+        bool laidOut = offset >= header_.headerSize && offset <= fileSize_
+                       && header_.recordCount <= (offset - header_.headerSize) / TelemetryRecordSize;
+        if (!laidOut || !readDictionary()) {
+            std::cerr << "Corrupt telemetry file: " << path_ << std::endl;
+            unmap();
+            return;
+        }
+        recordCount_ = static_cast<size_t>(header_.recordCount);
+    } else {
+        // Writer did not finish: take every whole record on disk, without ids
+        std::cerr << "Telemetry file was not closed cleanly, ids unavailable: " << path_ << std::endl;
+        recordCount_ = (fileSize_ - header_.headerSize) / TelemetryRecordSize;
+    }
+}
+
+// Destructor unmaps the file
+TelemetryReader::~TelemetryReader() {
+    unmap();
+}
+
+// Parse the id dictionary
+bool TelemetryReader::readDictionary() {
+    std::uint64_t offset = header_.dictionaryOffset;
+    if (offset < header_.headerSize || offset > fileSize_ || fileSize_ - offset < 4) {
+        return false;
+    }
+
+    const unsigned char* position = data_ + offset;
+    const unsigned char* end = data_ + fileSize_;
+    std::uint32_t count = loadLE32(position);
+    position += 4;
+
+    // Every entry takes at least its length prefix
+    if (count > static_cast<size_t>(end - position) / 2) {
+        return false;
+    }
+
+    ids_.reserve(count);
+    for (std::uint32_t i = 0; i < count; ++i) {
+        if (end - position < 2) {
+            return false;
+        }
+        std::uint16_t length = loadLE16(position);
+        position += 2;
+        if (end - position < length) {
+            return false;
+        }
+        ids_.emplace_back(reinterpret_cast<const char*>(position), length);
+        position += length;
+    }
+    return true;
+}
+
+#if defined(_WIN32)
+
+// Map the file
+bool TelemetryReader::map() {
+    HANDLE file = CreateFileA(path_.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                              OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        std::cerr << "Error opening telemetry file: " << path_ << std::endl;
+        return false;
+    }
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) {
+        std::cerr << "Empty telemetry file: " << path_ << std::endl;
+        CloseHandle(file);
+        return false;
+    }
+
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mapping == nullptr) {
+        std::cerr << "Error mapping telemetry file: " << path_ << std::endl;
+        CloseHandle(file);
+        return false;
+    }
+
+    void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (view == nullptr) {
+        std::cerr << "Error mapping telemetry file: " << path_ << std::endl;
+        CloseHandle(mapping);
+        CloseHandle(file);
+        return false;
+    }
+
+    fileHandle_ = file;
+    mappingHandle_ = mapping;
+    data_ = static_cast<const unsigned char*>(view);
+    fileSize_ = static_cast<size_t>(size.QuadPart);
+    return true;
+}
+
+// Release the mapping
+void TelemetryReader::unmap() {
+    if (data_ != nullptr) {
+        UnmapViewOfFile(data_);
+    }
+    if (mappingHandle_ != nullptr) {
+        CloseHandle(static_cast<HANDLE>(mappingHandle_));
+    }
+    if (fileHandle_ != nullptr) {
+        CloseHandle(static_cast<HANDLE>(fileHandle_));
+    }
+    data_ = nullptr;
+    mappingHandle_ = nullptr;
+    fileHandle_ = nullptr;
+    records_ = nullptr;
+    recordCount_ = 0;
+    ids_.clear();
+}
+
+#else
+
+// Map the file
+bool TelemetryReader::map() {
+    int fd = ::open(path_.c_str(), O_RDONLY);
+    if (fd < 0) {
+        std::cerr << "Error opening telemetry file: " << path_ << std::endl;
+        return false;
+    }
+
+    struct stat info;
+    if (::fstat(fd, &info) != 0 || info.st_size == 0) {
+        std::cerr << "Empty telemetry file: " << path_ << std::endl;
+        ::close(fd);
+        return false;
+    }
+
+    size_t size = static_cast<size_t>(info.st_size);
+    void* mapping = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd); // The mapping keeps the file referenced
+    if (mapping == MAP_FAILED) {
+        std::cerr << "Error mapping telemetry file: " << path_ << std::endl;
+        return false;
+    }
+
+    // Scans read front to back
+    ::madvise(mapping, size, MADV_SEQUENTIAL);
+
+    data_ = static_cast<const unsigned char*>(mapping);
+    fileSize_ = size;
+    return true;
+}
+
+// Release the mapping
+void TelemetryReader::unmap() {
+    if (data_ != nullptr) {
+        ::munmap(const_cast<unsigned char*>(data_), fileSize_);
+    }
+    data_ = nullptr;
+    records_ = nullptr;
+    recordCount_ = 0;
+    ids_.clear();
+}
+
+#endif
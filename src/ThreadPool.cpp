@@ -0,0 +1,142 @@
+#include "ThreadPool.h"
+#include <algorithm>
+
+// Constructor implementation
+ThreadPool::ThreadPool(size_t threadCount)
+        : job_(nullptr),
+          pendingChunks_(0),
+          generation_(0),
+          stopping_(false) {
+
+    threadCount = std::max<size_t>(threadCount, 1);
+    for (size_t i = 0; i < threadCount; ++i) {
+        queues_.push_back(std::make_unique<WorkQueue>());
+    }
+
+    // Thread 0 is the caller of parallelFor
+    for (size_t i = 1; i < threadCount; ++i) {
+        workers_.emplace_back(&ThreadPool::workerLoop, this, i);
+    }
+}
+
+// Destructor
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    wakeCondition_.notify_all();
+
+    for (auto& worker : workers_) {
+        worker.join();
+    }
+}
+
+// Run fn over [0, count) and wait for completion
+void ThreadPool::parallelFor(size_t count, size_t chunkSize, const RangeFunction& fn) {
+    if (count == 0) {
+        return;
+    }
+
+    chunkSize = std::max<size_t>(chunkSize, 1);
+    size_t chunkCount = (count + chunkSize - 1) / chunkSize;
+
+    // Nothing to share, run inline
+    if (workers_.empty() || chunkCount == 1) {
+        fn(0, count);
+        return;
+    }
+
+    // Publish the job before any chunk becomes visible to a worker
+    job_ = &fn;
+    pendingChunks_.store(chunkCount, std::memory_order_relaxed);
+
+    // Deal chunks out in contiguous blocks so each thread walks adjacent memory
+    size_t queueCount = queues_.size();
+    for (size_t q = 0; q < queueCount; ++q) {
+        size_t first = chunkCount * q / queueCount;
+        size_t last = chunkCount * (q + 1) / queueCount;
+
+        std::lock_guard<std::mutex> lock(queues_[q]->mutex);
+        for (size_t c = first; c < last; ++c) {
+            size_t begin = c * chunkSize;
+            queues_[q]->chunks.push_back({begin, std::min(begin + chunkSize, count)});
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ++generation_;
+    }
+    wakeCondition_.notify_all();
+
+    // Take part in the work, then wait at the barrier
+    runChunks(0);
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    doneCondition_.wait(lock, [this] {
+        return pendingChunks_.load(std::memory_order_acquire) == 0;
+    });
+    job_ = nullptr;
+}
+
+// Worker thread main loop
+void ThreadPool::workerLoop(size_t index) {
+    std::uint64_t seenGeneration = 0;
+
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            wakeCondition_.wait(lock, [&] {
+                return stopping_ || generation_ != seenGeneration;
+            });
+            if (stopping_) {
+                return;
+            }
+            seenGeneration = generation_;
+        }
+
+        runChunks(index);
+    }
+}
+
+// Run chunks until no work is left anywhere
+void ThreadPool::runChunks(size_t index) {
+    Chunk chunk;
+    while (popLocal(index, chunk) || steal(index, chunk)) {
+        (*job_)(chunk.begin, chunk.end);
+
+        // Last chunk releases the barrier
+        if (pendingChunks_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            doneCondition_.notify_all();
+        }
+    }
+}
+
+// Take a chunk from the front of the own queue
+bool ThreadPool::popLocal(size_t index, Chunk& chunk) {
+    WorkQueue& queue = *queues_[index];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.chunks.empty()) {
+        return false;
+    }
+    chunk = queue.chunks.front();
+    queue.chunks.pop_front();
+    return true;
+}
+
+// Take a chunk from the back of another thread's queue
+bool ThreadPool::steal(size_t index, Chunk& chunk) {
+    size_t queueCount = queues_.size();
+    for (size_t offset = 1; offset < queueCount; ++offset) {
+        WorkQueue& victim = *queues_[(index + offset) % queueCount];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.chunks.empty()) {
+            chunk = victim.chunks.back();
+            victim.chunks.pop_back();
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,461 @@
+#include "UringFileWriter.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+#if defined(__linux__)
+#include <fcntl.h>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+// Alignment of buffers, offsets and lengths for direct I/O
+constexpr size_t DirectIoBlockSize = 4096;
+
+// Round up to a multiple of step
+size_t roundUp(size_t value, size_t step) {
+    return (value + step - 1) / step * step;
+}
+
+#if defined(__linux__)
+
+int uringSetup(unsigned entries, io_uring_params* params) {
+    return static_cast<int>(::syscall(__NR_io_uring_setup, entries, params));
+}
+
+int uringEnter(int ringFd, unsigned toSubmit, unsigned minComplete, unsigned flags) {
+    return static_cast<int>(::syscall(__NR_io_uring_enter, ringFd, toSubmit, minComplete, flags, nullptr, 0));
+}
+
+int uringRegister(int ringFd, unsigned opcode, const void* arg, unsigned count) {
+    return static_cast<int>(::syscall(__NR_io_uring_register, ringFd, opcode, arg, count));
+}
+
+#endif
+
+} // namespace
+
+// Constructor with the file to create and the writer settings
+UringFileWriter::UringFileWriter(const std::string& path, const UringWriterConfig& config)
+        : path_(path),
+          config_(config),
+          blockSize_(DirectIoBlockSize),
+          fileFd_(-1),
+          ringFd_(-1),
+          sqRing_(nullptr),
+          sqRingSize_(0),
+          cqRing_(nullptr),
+          cqRingSize_(0),
+          sqes_(nullptr),
+          sqesSize_(0),
+          sqHead_(nullptr),
+          sqTail_(nullptr),
+          sqMask_(0),
+          sqArray_(nullptr),
+          cqHead_(nullptr),
+          cqTail_(nullptr),
+          cqMask_(0),
+          cqes_(nullptr),
+          current_(0),
+          nextOffset_(0),
+          inFlight_(0),
+          latencyTotal_(0.0) {
+
+    config_.bufferBytes = roundUp(config_.bufferBytes > 0 ? config_.bufferBytes : 1, blockSize_);
+    config_.queueDepth = std::max<size_t>(config_.queueDepth, 2);
+
+#if defined(__linux__)
+    if (!setupRing()) {
+        teardown();
+        return;
+    }
+
+    // Open file for writing, without direct I/O if the file system refuses it
+    int flags = O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC;
+    if (config_.directIo) {
+        fileFd_ = ::open(path.c_str(), flags | O_DIRECT, 0644);
+        if (fileFd_ >= 0) {
+            stats_.directIo = true;
+        } else if (errno == EINVAL) {
+            std::cerr << "Direct I/O not supported for " << path << ", using the page cache" << std::endl;
+        }
+    }
+    if (fileFd_ < 0) {
+        fileFd_ = ::open(path.c_str(), flags, 0644);
+    }
+    if (fileFd_ < 0) {
+        std::cerr << "Error opening output file: " << path << std::endl;
+        teardown();
+        return;
+    }
+
+    if (!setupBuffers()) {
+        teardown();
+        return;
+    }
+#else
+    std::cerr << "io_uring is not available on this platform" << std::endl;
+#endif
+}
+
+// Destructor closes the file
+UringFileWriter::~UringFileWriter() {
+    close();
+    teardown();
+}
+
+// Append bytes, submitting every buffer that fills up
+bool UringFileWriter::write(const char* data, size_t size) {
+    if (!isOpen()) {
+        return false;
+    }
+
+    bool written = true;
+    while (size > 0) {
+        Buffer& buffer = buffers_[current_];
+        size_t count = std::min(size, config_.bufferBytes - buffer.size);
+        std::memcpy(buffer.data + buffer.size, data, count);
+        buffer.size += count;
+        nextOffset_ += count;
+        data += count;
+        size -= count;
+
+        if (buffer.size == config_.bufferBytes) {
+            written = submit() && written;
+        }
+    }
+
+    // Pick up finished writes without waiting, so buffers come back early
+    return reap(false) && written;
+}
+
+// Submit what is buffered
+bool UringFileWriter::submit() {
+    if (!isOpen()) {
+        return false;
+    }
+
+    Buffer& buffer = buffers_[current_];
+    size_t end = stats_.directIo ? buffer.size / blockSize_ * blockSize_ : buffer.size;
+    if (end == 0) {
+        return true;
+    }
+
+    bool submitted = submitWrite(current_, 0, end);
+
+    // Bytes past the last whole block move to the next buffer; the kernel
+    // only reads the submitted range, so copying them out is safe
+    size_t previous = current_;
+    size_t tail = buffer.size - end;
+    std::uint64_t tailOffset = buffer.fileOffset + end;
+    if (!nextFreeBuffer()) {
+        return false;
+    }
+    Buffer& next = buffers_[current_];
+    next.fileOffset = tailOffset;
+    if (tail > 0) {
+        std::memcpy(next.data, buffers_[previous].data + end, tail);
+        next.size = tail;
+    }
+    return submitted;
+}
+
+// Submit what is buffered and wait for every write to complete
+bool UringFileWriter::flush() {
+    if (!isOpen()) {
+        return false;
+    }
+
+    bool flushed = submit();
+    while (inFlight_ > 0) {
+        flushed = reap(true) && flushed;
+    }
+    return flushed;
+}
+
+// Write the remainder, wait for completion and close the file
+bool UringFileWriter::close() {
+#if defined(__linux__)
+    if (!isOpen()) {
+        return false;
+    }
+
+    bool closed = flush();
+
+    // With direct I/O the last partial block goes out padded, then the
+    // file is trimmed back to its real length
+    Buffer& buffer = buffers_[current_];
+    if (buffer.size > 0) {
+        size_t padded = roundUp(buffer.size, blockSize_);
+        std::memset(buffer.data + buffer.size, 0, padded - buffer.size);
+        closed = submitWrite(current_, 0, padded) && closed;
+        while (inFlight_ > 0) {
+            closed = reap(true) && closed;
+        }
+        if (::ftruncate(fileFd_, static_cast<off_t>(nextOffset_)) != 0) {
+            std::cerr << "Error trimming output file: " << path_ << std::endl;
+            closed = false;
+        }
+        buffer.size = 0;
+    }
+
+    ::close(fileFd_);
+    fileFd_ = -1;
+    return closed;
+#else
+    return false;
+#endif
+}
+
+// Counters so far
+UringWriterStats UringFileWriter::getStats() const {
+    UringWriterStats stats = stats_;
+    if (stats.writesCompleted > 0) {
+        stats.averageLatencySeconds = latencyTotal_ / static_cast<double>(stats.writesCompleted);
+    }
+    return stats;
+}
+
+#if defined(__linux__)
+
+// Create the ring and map its regions
+bool UringFileWriter::setupRing() {
+    // Room for every buffer's write plus resubmitted short writes
+    unsigned entries = 1;
+    while (entries < config_.queueDepth * 2) {
+        entries <<= 1;
+    }
+
+    io_uring_params params;
+    std::memset(&params, 0, sizeof(params));
+    ringFd_ = uringSetup(entries, &params);
+    if (ringFd_ < 0) {
+        std::cerr << "io_uring unavailable: " << std::strerror(errno) << std::endl;
+        return false;
+    }
+
+    // Plain writes need Linux 5.6; ask the kernel rather than guess
+    std::vector<unsigned char> probeStorage(sizeof(io_uring_probe) + 256 * sizeof(io_uring_probe_op), 0);
+    auto* probe = reinterpret_cast<io_uring_probe*>(probeStorage.data());
+    if (uringRegister(ringFd_, IORING_REGISTER_PROBE, probe, 256) < 0
+        || probe->last_op < IORING_OP_WRITE
+        || !(probe->ops[IORING_OP_WRITE].flags & IO_URING_OP_SUPPORTED)) {
+        std::cerr << "io_uring unavailable: kernel does not support IORING_OP_WRITE" << std::endl;
+        return false;
+    }
+
+    sqRingSize_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    cqRingSize_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    bool singleMap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+    if (singleMap) {
+        sqRingSize_ = cqRingSize_ = std::max(sqRingSize_, cqRingSize_);
+    }
+
+    sqRing_ = ::mmap(nullptr, sqRingSize_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                     ringFd_, IORING_OFF_SQ_RING);
+    if (sqRing_ == MAP_FAILED) {
+        sqRing_ = nullptr;
+        std::cerr << "io_uring unavailable: cannot map submission ring" << std::endl;
+        return false;
+    }
+    if (singleMap) {
+        cqRing_ = sqRing_;
+    } else {
+        cqRing_ = ::mmap(nullptr, cqRingSize_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                         ringFd_, IORING_OFF_CQ_RING);
+        if (cqRing_ == MAP_FAILED) {
+            cqRing_ = nullptr;
+            std::cerr << "io_uring unavailable: cannot map completion ring" << std::endl;
+            return false;
+        }
+    }
+
+    sqesSize_ = params.sq_entries * sizeof(io_uring_sqe);
+    sqes_ = ::mmap(nullptr, sqesSize_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                   ringFd_, IORING_OFF_SQES);
+    if (sqes_ == MAP_FAILED) {
+        sqes_ = nullptr;
+        std::cerr << "io_uring unavailable: cannot map submission entries" << std::endl;
+        return false;
+    }
+
+    auto* sq = static_cast<char*>(sqRing_);
+    sqHead_ = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+    sqTail_ = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+    sqMask_ = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+    sqArray_ = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+
+    auto* cq = static_cast<char*>(cqRing_);
+    cqHead_ = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+    cqTail_ = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+    cqMask_ = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+    cqes_ = cq + params.cq_off.cqes;
+    return true;
+}
+
+// Allocate the buffer pool and try to register it
+bool UringFileWriter::setupBuffers() {
+    buffers_.resize(config_.queueDepth);
+    std::vector<iovec> iovecs(config_.queueDepth);
+    for (size_t i = 0; i < buffers_.size(); ++i) {
+        void* data = nullptr;
+        if (::posix_memalign(&data, blockSize_, config_.bufferBytes) != 0) {
+            std::cerr << "Error allocating io_uring buffers" << std::endl;
+            return false;
+        }
+        buffers_[i].data = static_cast<char*>(data);
+        iovecs[i].iov_base = data;
+        iovecs[i].iov_len = config_.bufferBytes;
+    }
+
+    // Registration pins the pool once instead of on every write; it can
+    // fail under a low RLIMIT_MEMLOCK, in which case plain writes are used
+    stats_.registeredBuffers = uringRegister(ringFd_, IORING_REGISTER_BUFFERS, iovecs.data(),
+                                             static_cast<unsigned>(iovecs.size())) == 0;
+    return true;
+}
+
+// Release the ring, buffers and file
+void UringFileWriter::teardown() {
+    if (fileFd_ >= 0) {
+        ::close(fileFd_);
+        fileFd_ = -1;
+    }
+    if (sqes_ != nullptr) {
+        ::munmap(sqes_, sqesSize_);
+        sqes_ = nullptr;
+    }
+    if (cqRing_ != nullptr && cqRing_ != sqRing_) {
+        ::munmap(cqRing_, cqRingSize_);
+    }
+    cqRing_ = nullptr;
+    if (sqRing_ != nullptr) {
+        ::munmap(sqRing_, sqRingSize_);
+        sqRing_ = nullptr;
+    }
+    if (ringFd_ >= 0) {
+        ::close(ringFd_); // Also drops the buffer registration
+        ringFd_ = -1;
+    }
+    for (Buffer& buffer : buffers_) {
+        std::free(buffer.data);
+    }
+    buffers_.clear();
+}
+
+// Submit bytes [from, to) of a buffer at their file offset
+bool UringFileWriter::submitWrite(size_t index, size_t from, size_t to) {
+    Buffer& buffer = buffers_[index];
+
+    unsigned tail = *sqTail_; // Only this thread produces entries
+    unsigned slot = tail & sqMask_;
+    auto* sqe = static_cast<io_uring_sqe*>(sqes_) + slot;
+    std::memset(sqe, 0, sizeof(*sqe));
+    sqe->opcode = stats_.registeredBuffers ? IORING_OP_WRITE_FIXED : IORING_OP_WRITE;
+    sqe->fd = fileFd_;
+    sqe->addr = reinterpret_cast<std::uint64_t>(buffer.data + from);
+    sqe->len = static_cast<std::uint32_t>(to - from);
+    sqe->off = buffer.fileOffset + from;
+    sqe->buf_index = static_cast<std::uint16_t>(index);
+    sqe->user_data = index;
+    sqArray_[slot] = slot;
+    __atomic_store_n(sqTail_, tail + 1, __ATOMIC_RELEASE);
+
+    int submitted;
+    while ((submitted = uringEnter(ringFd_, 1, 0, 0)) < 0) {
+        if (errno != EINTR && errno != EAGAIN && errno != EBUSY) {
+            std::cerr << "io_uring submit failed: " << std::strerror(errno) << std::endl;
+            ++stats_.writeErrors;
+            return false;
+        }
+        // Completion queue is backed up: drain it and retry
+        reap(false);
+    }
+
+    if (!buffer.inFlight) {
+        buffer.inFlight = true;
+        buffer.submittedAt = std::chrono::steady_clock::now();
+        ++inFlight_;
+        stats_.maxInFlight = std::max(stats_.maxInFlight, inFlight_);
+    }
+    buffer.pendingFrom = from;
+    buffer.pendingTo = to;
+    ++stats_.writesSubmitted;
+    return true;
+}
+
+// Process finished writes
+bool UringFileWriter::reap(bool wait) {
+    if (wait && inFlight_ > 0) {
+        while (uringEnter(ringFd_, 0, 1, IORING_ENTER_GETEVENTS) < 0 && errno == EINTR) {
+        }
+    }
+
+    bool ok = true;
+    unsigned head = *cqHead_; // Only this thread consumes completions
+    unsigned tail = __atomic_load_n(cqTail_, __ATOMIC_ACQUIRE);
+    while (head != tail) {
+        const io_uring_cqe& cqe = static_cast<const io_uring_cqe*>(cqes_)[head & cqMask_];
+        size_t index = static_cast<size_t>(cqe.user_data);
+        int result = cqe.res;
+        ++head;
+        __atomic_store_n(cqHead_, head, __ATOMIC_RELEASE);
+
+        Buffer& buffer = buffers_[index];
+        size_t expected = buffer.pendingTo - buffer.pendingFrom;
+        if (result > 0) {
+            stats_.bytesWritten += static_cast<std::uint64_t>(result);
+        }
+        if (result > 0 && static_cast<size_t>(result) < expected) {
+            // Short write: send the rest from the same buffer
+            ok = submitWrite(index, buffer.pendingFrom + static_cast<size_t>(result), buffer.pendingTo) && ok;
+        } else {
+            if (result < 0 || static_cast<size_t>(result) != expected) {
+                std::cerr << "io_uring write to " << path_ << " failed: "
+                          << std::strerror(result < 0 ? -result : EIO) << std::endl;
+                ++stats_.writeErrors;
+                ok = false;
+            }
+            double latency = std::chrono::duration<double>(std::chrono::steady_clock::now() - buffer.submittedAt).count();
+            latencyTotal_ += latency;
+            stats_.maxLatencySeconds = std::max(stats_.maxLatencySeconds, latency);
+            ++stats_.writesCompleted;
+            buffer.inFlight = false;
+            --inFlight_;
+        }
+        tail = __atomic_load_n(cqTail_, __ATOMIC_ACQUIRE);
+    }
+    return ok;
+}
+
+#else
+
+bool UringFileWriter::setupRing() { return false; }
+bool UringFileWriter::setupBuffers() { return false; }
+void UringFileWriter::teardown() {}
+bool UringFileWriter::submitWrite(size_t, size_t, size_t) { return false; }
+bool UringFileWriter::reap(bool) { return false; }
+
+#endif
+
+// Make the current buffer one that is not in flight
+bool UringFileWriter::nextFreeBuffer() {
+    size_t next = (current_ + 1) % buffers_.size();
+    if (buffers_[next].inFlight) {
+        // Every buffer is in flight: the disk is behind, wait for the oldest
+        ++stats_.bufferWaits;
+        while (buffers_[next].inFlight) {
+            reap(true);
+        }
+    }
+    current_ = next;
+    buffers_[current_].size = 0;
+    return true;
+}
@@ -0,0 +1,111 @@
+#include "VehicleSerializer.h"
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <nlohmann/json.hpp>
+
+namespace {
+
+// Copy a string literal without its terminator
+template <size_t N>
+char* appendLiteral(char* out, const char (&text)[N]) {
+    std::memcpy(out, text, N - 1);
+    return out + N - 1;
+}
+
+// Copy a byte string
+char* appendBytes(char* out, const std::string& text) {
+    std::memcpy(out, text.data(), text.size());
+    return out + text.size();
+}
+
+// Format a double the way json::dump() does.
+// std::to_chars would give the shortest digits, but nlohmann's Grisu2
+// occasionally emits one digit more; using the library's own conversion is
+// what keeps the output byte-identical.
+char* appendDouble(char* out, double value) {
+    if (!std::isfinite(value)) {
+        return appendLiteral(out, "null");
+    }
+    return nlohmann::detail::to_chars(out, out + 64, value);
+}
+
+// Format an integer
+char* appendInteger(char* out, long long value) {
+    return std::to_chars(out, out + 24, value).ptr;
+}
+
+// Compact record layout; out must have room for MaxRecordOverhead plus the id
+char* writeCompact(char* out, const std::string& id, const VehicleState& state, std::time_t timestamp) {
+    out = appendLiteral(out, "{\"heading\":");
+    out = appendDouble(out, state.heading);
+    out = appendLiteral(out, ",\"id\":");
+    out = appendBytes(out, id);
+    out = appendLiteral(out, ",\"position\":{\"lat\":");
+    out = appendDouble(out, state.position.lat);
+    out = appendLiteral(out, ",\"lon\":");
+    out = appendDouble(out, state.position.lon);
+    out = appendLiteral(out, "},\"speed\":");
+    out = appendDouble(out, state.speed);
+    out = appendLiteral(out, ",\"timestamp\":");
+    out = appendInteger(out, static_cast<long long>(timestamp));
+    *out++ = '}';
+    return out;
+}
+
+} // namespace
+
+// Append the compact JSON of a state with its timestamp
+void VehicleJsonSerializer::append(std::string& out, const VehicleState& state, std::time_t timestamp) {
+    const std::string& id = escapedId(state);
+    size_t start = out.size();
+    out.resize(start + id.size() + MaxRecordOverhead);
+    char* end = writeCompact(&out[start], id, state, timestamp);
+    out.resize(static_cast<size_t>(end - out.data()));
+}
+
+// Append the state without timestamp, indented by two spaces
+void VehicleJsonSerializer::appendIndented(std::string& out, const VehicleState& state) {
+    const std::string& id = escapedId(state);
+    size_t start = out.size();
+    out.resize(start + id.size() + MaxRecordOverhead);
+
+    char* end = &out[start];
+    end = appendLiteral(end, "{\n  \"heading\": ");
+    end = appendDouble(end, state.heading);
+    end = appendLiteral(end, ",\n  \"id\": ");
+    end = appendBytes(end, id);
+    end = appendLiteral(end, ",\n  \"position\": {\n    \"lat\": ");
+    end = appendDouble(end, state.position.lat);
+    end = appendLiteral(end, ",\n    \"lon\": ");
+    end = appendDouble(end, state.position.lon);
+    end = appendLiteral(end, "\n  },\n  \"speed\": ");
+    end = appendDouble(end, state.speed);
+    end = appendLiteral(end, "\n}");
+    out.resize(static_cast<size_t>(end - out.data()));
+}
+
+// Write the compact JSON into [first, last)
+char* VehicleJsonSerializer::write(char* first, char* last, const VehicleState& state, std::time_t timestamp) {
+    const std::string& id = escapedId(state);
+    if (static_cast<size_t>(last - first) < id.size() + MaxRecordOverhead) {
+        return nullptr;
+    }
+    return writeCompact(first, id, state, timestamp);
+}
+
+// Escaped and quoted id of a state, cached by handle
+const std::string& VehicleJsonSerializer::escapedId(const VehicleState& state) {
+    if (state.handle >= ids_.size()) {
+        ids_.resize(static_cast<size_t>(state.handle) + 1);
+    }
+
+    CachedId& cached = ids_[state.handle];
+    if (cached.source != state.id.data() || cached.size != state.id.size()) {
+        // Let the library escape it so the bytes match json::dump()
+        cached.escaped = nlohmann::json(state.id).dump();
+        cached.source = state.id.data();
+        cached.size = state.id.size();
+    }
+    return cached.escaped;
+}
@@ -1,47 +1,49 @@
 #include "Simulation.h"
 #include "Simulation.h"
+#include "BinaryPublisher.h"
+#include "ConsolePublisher.h"
+#include "DeadReckoningFilter.h"
 #include "FilePublisher.h"
-#include <iostream>
-#include <thread>
-#include <chrono>
-#include <nlohmann/json.hpp>
-
-#ifdef USE_KAFKA
 #include "KafkaPublisher.h"
-#endif
-
-// For JSON serialization
-using json = nlohmann::json;
-
-// Convert vehicle to JSON
-json vehicleToJson(const Vehicle& vehicle) {
-    json j;
-    j["id"] = vehicle.getId();
-    j["position"] = {
-            {"lat", vehicle.getPosition().lat},
-            {"lon", vehicle.getPosition().lon}
-    };
-    j["heading"] = vehicle.getHeading();
-    j["speed"] = vehicle.getSpeed();
-    return j;
-}
-
-// Vehicle update callback to print updates
-void printVehicleUpdate(const Vehicle& vehicle) {
-    json j = vehicleToJson(vehicle);
-    std::cout << j.dump(2) << std::endl;
-}
+#include "MappedFilePublisher.h"
+#include "MockKafkaBackend.h"
+#include "PublishDispatcher.h"
+#include <iostream>
 
 int main(int argc, char* argv[]) {
     // Default configuration
     std::string outputFile = "vehicle_positions.json";
     bool useFile = true;
+    size_t threadCount = 1;
+    KernelIsa kernelIsa = detectKernelIsa(); // Best the CPU supports; --kernel scalar for the reference path
+    bool validateKernel = false;
+    bool pipelined = false;
+    LagPolicy lagPolicy = LagPolicy::Block;
+    double realTimeFactor = 10.0; // Simulated seconds per wall-clock second
+    SinkPolicy sinkPolicy; // Queueing policy of every output sink
+    bool deadReckoning = false;
+    DeadReckoningConfig deadReckoningConfig;
+    FileFormat fileFormat = FileFormat::JsonArray;
+    FlushPolicy flushPolicy;
+    FileBackend fileBackend = FileBackend::Stream;
+    UringWriterConfig uringConfig;
+    RotationPolicy rotationPolicy; // Split the output file into segments; off by default
+    std::string binaryFile; // Binary telemetry output, off when empty
+    std::string mappedFile; // Memory-mapped NDJSON output, off when empty
+    MappedFileConfig mappedFileConfig;
+    bool useConsole = true; // Periodic summary and sampled updates on stdout
+    ConsoleConfig consoleConfig;
 
-#ifdef USE_KAFKA
     std::string kafkaBroker = "localhost:9092";
     std::string kafkaTopic = "vehicle-positions";
+#ifdef USE_KAFKA
     bool useKafka = true;
+#else
+    bool useKafka = false; // Only the in-process mock broker is available
 #endif
+    KafkaConfig kafkaConfig;
+    bool kafkaMock = false; // Publish to an in-process stand-in instead of a broker
+    MockKafkaConfig mockKafkaConfig;
 
     // Check command line arguments
     for (int i = 1; i < argc; i++) {
@@ -50,16 +52,153 @@ int main(int argc, char* argv[]) {
             outputFile = argv[++i];
         } else if (arg == "--no-file") {
             useFile = false;
+        } else if (arg == "--no-console") {
+            useConsole = false;
+        } else if (arg == "--console-interval" && i + 1 < argc) {
+            consoleConfig.intervalSeconds = std::stod(argv[++i]);
+        } else if (arg == "--console-sample-id" && i + 1 < argc) {
+            consoleConfig.sampleIds.insert(argv[++i]);
+        } else if (arg == "--console-sample-every" && i + 1 < argc) {
+            consoleConfig.sampleEvery = std::stoull(argv[++i]);
+        } else if (arg == "--format" && i + 1 < argc) {
+            std::string format = argv[++i];
+            fileFormat = format == "ndjson" ? FileFormat::Ndjson : FileFormat::JsonArray;
+        } else if (arg == "--flush-bytes" && i + 1 < argc) {
+            flushPolicy.bytes = std::stoul(argv[++i]);
+        } else if (arg == "--flush-records" && i + 1 < argc) {
+            flushPolicy.records = std::stoul(argv[++i]);
+        } else if (arg == "--flush-interval" && i + 1 < argc) {
+            flushPolicy.intervalSeconds = std::stod(argv[++i]);
+        } else if (arg == "--flush-every-tick") {
+            flushPolicy.everyTick = true;
+        } else if (arg == "--rotate-bytes" && i + 1 < argc) {
+            rotationPolicy.bytes = std::stoul(argv[++i]);
+        } else if (arg == "--rotate-seconds" && i + 1 < argc) {
+            rotationPolicy.simulationSeconds = std::stod(argv[++i]);
+        } else if (arg == "--io-uring") {
+            fileBackend = FileBackend::IoUring;
+        } else if (arg == "--uring-depth" && i + 1 < argc) {
+            uringConfig.queueDepth = std::stoul(argv[++i]);
+        } else if (arg == "--uring-buffer-bytes" && i + 1 < argc) {
+            uringConfig.bufferBytes = std::stoul(argv[++i]);
+        } else if (arg == "--direct-io") {
+            uringConfig.directIo = true;
+        } else if (arg == "--binary-file" && i + 1 < argc) {
+            binaryFile = argv[++i];
+        } else if (arg == "--mmap-file" && i + 1 < argc) {
+            mappedFile = argv[++i];
+        } else if (arg == "--msync" && i + 1 < argc) {
+            std::string mode = argv[++i];
+            if (mode == "none") {
+                mappedFileConfig.sync.mode = SyncMode::None;
+            } else if (mode == "sync") {
+                mappedFileConfig.sync.mode = SyncMode::Sync;
+            } else {
+                mappedFileConfig.sync.mode = SyncMode::Async;
+            }
+        } else if (arg == "--msync-bytes" && i + 1 < argc) {
+            mappedFileConfig.sync.bytes = std::stoul(argv[++i]);
+        } else if (arg == "--msync-interval" && i + 1 < argc) {
+            mappedFileConfig.sync.intervalSeconds = std::stod(argv[++i]);
+        } else if (arg == "--msync-every-tick") {
+            mappedFileConfig.sync.everyPublish = true;
+        } else if (arg == "--threads" && i + 1 < argc) {
+            threadCount = std::stoul(argv[++i]);
+        } else if (arg == "--kernel" && i + 1 < argc) {
+            std::string name = argv[++i];
+            if (name == "auto") {
+                kernelIsa = detectKernelIsa();
+            } else if (name == "sse2") {
+                kernelIsa = KernelIsa::SSE2;
+            } else if (name == "avx2") {
+                kernelIsa = KernelIsa::AVX2;
+            } else if (name == "avx512") {
+                kernelIsa = KernelIsa::AVX512;
+            } else {
+                kernelIsa = KernelIsa::Scalar;
+            }
+        } else if (arg == "--validate-kernel") {
+            validateKernel = true;
+        } else if (arg == "--rtf" && i + 1 < argc) {
+            realTimeFactor = std::stod(argv[++i]);
+        } else if (arg == "--fast") {
+            realTimeFactor = 0.0;
+        } else if (arg == "--sink-policy" && i + 1 < argc) {
+            std::string policy = argv[++i];
+            if (policy == "drop-oldest") {
+                sinkPolicy.backpressure = BackpressurePolicy::DropOldest;
+            } else if (policy == "sample") {
+                sinkPolicy.backpressure = BackpressurePolicy::Sample;
+            } else {
+                sinkPolicy.backpressure = BackpressurePolicy::Block;
+            }
+        } else if (arg == "--sink-queue" && i + 1 < argc) {
+            sinkPolicy.queueDepth = std::stoul(argv[++i]);
+        } else if (arg == "--sample-every" && i + 1 < argc) {
+            sinkPolicy.sampleEvery = std::stoul(argv[++i]);
+        } else if (arg == "--dead-reckoning") {
+            deadReckoning = true;
+        } else if (arg == "--dr-distance" && i + 1 < argc) {
+            deadReckoningConfig.distanceThreshold = std::stod(argv[++i]);
+        } else if (arg == "--dr-heading" && i + 1 < argc) {
+            deadReckoningConfig.headingThreshold = std::stod(argv[++i]) * M_PI / 180.0;
+        } else if (arg == "--dr-heartbeat" && i + 1 < argc) {
+            deadReckoningConfig.maxIntervalSeconds = std::stod(argv[++i]);
+        } else if (arg == "--async") {
+            // Never hold up a tick for a slow sink
+            sinkPolicy.backpressure = BackpressurePolicy::DropOldest;
+        } else if (arg == "--pipeline" && i + 1 < argc) {
+            std::string policy = argv[++i];
+            pipelined = true;
+            if (policy == "drop") {
+                lagPolicy = LagPolicy::Drop;
+            } else if (policy == "coalesce") {
+                lagPolicy = LagPolicy::Coalesce;
+            } else {
+                lagPolicy = LagPolicy::Block;
+            }
         }
-#ifdef USE_KAFKA
         else if (arg == "--no-kafka") {
             useKafka = false;
         } else if (arg == "--broker" && i + 1 < argc) {
             kafkaBroker = argv[++i];
         } else if (arg == "--topic" && i + 1 < argc) {
             kafkaTopic = argv[++i];
+        } else if (arg == "--kafka-linger-ms" && i + 1 < argc) {
+            kafkaConfig.lingerMs = std::stoi(argv[++i]);
+        } else if (arg == "--kafka-batch-bytes" && i + 1 < argc) {
+            kafkaConfig.batchBytes = std::stoi(argv[++i]);
+        } else if (arg == "--kafka-compression" && i + 1 < argc) {
+            kafkaConfig.compression = argv[++i];
+        } else if (arg == "--kafka-queue-messages" && i + 1 < argc) {
+            kafkaConfig.queueMaxMessages = std::stoi(argv[++i]);
+        } else if (arg == "--kafka-acks" && i + 1 < argc) {
+            kafkaConfig.acks = argv[++i];
+        } else if (arg == "--kafka-queue-full-timeout-ms" && i + 1 < argc) {
+            kafkaConfig.queueFullTimeoutMs = std::stoi(argv[++i]);
+        } else if (arg == "--kafka-encoding" && i + 1 < argc) {
+            std::string encoding = argv[++i];
+            if (encoding == "delta") {
+                kafkaConfig.encoding = KafkaEncoding::Delta;
+            } else {
+                kafkaConfig.encoding = KafkaEncoding::Json;
+            }
+        } else if (arg == "--kafka-keyframe-interval" && i + 1 < argc) {
+            kafkaConfig.keyframeInterval = static_cast<std::uint32_t>(std::stoul(argv[++i]));
+        } else if (arg == "--kafka-aggregate-partitions" && i + 1 < argc) {
+            kafkaConfig.aggregatePartitions = std::stoi(argv[++i]);
+        } else if (arg == "--kafka-mock") {
+            useKafka = true;
+            kafkaMock = true;
+        } else if (arg == "--mock-ack-latency-ms" && i + 1 < argc) {
+            mockKafkaConfig.ackLatencyMs = std::stod(argv[++i]);
+        } else if (arg == "--mock-ack-jitter-ms" && i + 1 < argc) {
+            mockKafkaConfig.ackJitterMs = std::stod(argv[++i]);
+        } else if (arg == "--mock-bytes-per-second" && i + 1 < argc) {
+            mockKafkaConfig.bytesPerSecond = std::stod(argv[++i]);
+        } else if (arg == "--mock-failure-rate" && i + 1 < argc) {
+            mockKafkaConfig.failureRate = std::stod(argv[++i]);
         }
-#endif
     }
 
     // Initialize publishers
@@ -67,25 +206,33 @@ int main(int argc, char* argv[]) {
     if (useFile) {
         std::cout << "Initializing file publisher to " << outputFile << std::endl;
         try {
-            filePublisher = std::make_unique<FilePublisher>(outputFile);
+            filePublisher = std::make_unique<FilePublisher>(outputFile, fileFormat, flushPolicy, fileBackend, uringConfig,
+                                                            rotationPolicy);
         } catch (const std::exception& e) {
             std::cerr << "Failed to initialize file publisher: " << e.what() << std::endl;
             useFile = false;
         }
     }
 
-#ifdef USE_KAFKA
     std::unique_ptr<KafkaPublisher> kafkaPublisher;
+    MockKafkaBackend* mockKafka = nullptr; // Owned by the publisher
     if (useKafka) {
         std::cout << "Initializing Kafka publisher..." << std::endl;
         try {
-            kafkaPublisher = std::make_unique<KafkaPublisher>(kafkaBroker, kafkaTopic);
+            if (kafkaMock) {
+                mockKafkaConfig.queueMaxMessages = static_cast<size_t>(kafkaConfig.queueMaxMessages);
+                auto backend = std::make_unique<MockKafkaBackend>(mockKafkaConfig);
+                mockKafka = backend.get();
+                kafkaPublisher = std::make_unique<KafkaPublisher>(std::move(backend), kafkaConfig);
+            } else {
+                kafkaPublisher = std::make_unique<KafkaPublisher>(kafkaBroker, kafkaTopic, kafkaConfig);
+            }
+            useKafka = kafkaPublisher->isReady();
         } catch (const std::exception& e) {
             std::cerr << "Failed to initialize Kafka: " << e.what() << std::endl;
             useKafka = false;
         }
     }
-#endif
 
     // Create routes
     Route route1;
@@ -94,47 +241,157 @@ int main(int argc, char* argv[]) {
     route1.addWaypoint({37.7839, -122.4104}); // Moving north
     route1.addWaypoint({37.7839, -122.4014}); // Moving east again
 
-    // Create vehicles
-    auto vehicle1 = std::make_shared<Vehicle>("vehicle1", GeoPoint{37.7749, -122.4194}, route1);
-    vehicle1->setMaxSpeed(15.0); // Slower speed for testing
-
     // Create simulation
     Simulation sim(0.1); // 100ms time step
-    sim.addVehicle(vehicle1);
+    sim.setThreadCount(threadCount);
+    sim.setKernelIsa(kernelIsa);
+    sim.setKernelValidation(validateKernel);
+    std::cout << "Dynamics kernel: " << kernelIsaName(sim.getKernelIsa()) << std::endl;
+    if (pipelined) {
+        sim.enablePipelinedPublishing(lagPolicy);
+    }
 
-    // Register callback for console output
-    sim.registerVehicleUpdateCallback(printVehicleUpdate);
+    // Create vehicles
+    Vehicle vehicle1 = sim.addVehicle("vehicle1", GeoPoint{37.7749, -122.4194}, route1);
+    vehicle1.setMaxSpeed(15.0); // Slower speed for testing
 
-    // Register callbacks for publishers
-    if (useFile) {
-        sim.registerVehicleUpdateCallback([&filePublisher](const Vehicle& vehicle) {
-            filePublisher->publishVehicleUpdate(vehicle);
-        });
+    // Binary telemetry records the time step in its header
+    std::unique_ptr<BinaryPublisher> binaryPublisher;
+    if (!binaryFile.empty()) {
+        std::cout << "Initializing binary publisher to " << binaryFile << std::endl;
+        binaryPublisher = std::make_unique<BinaryPublisher>(binaryFile, sim.getTimeStep());
     }
 
-#ifdef USE_KAFKA
+    std::unique_ptr<MappedFilePublisher> mappedFilePublisher;
+    if (!mappedFile.empty()) {
+        std::cout << "Initializing memory-mapped file publisher to " << mappedFile << std::endl;
+        mappedFilePublisher = std::make_unique<MappedFilePublisher>(mappedFile, mappedFileConfig);
+    }
+
+    // Console output is a sink like the others, so printing never slows the
+    // simulation; it drops ticks rather than block when the terminal is slow
+    ConsolePublisher consolePublisher(consoleConfig, std::cout);
+    SinkPolicy consolePolicy;
+    consolePolicy.backpressure = BackpressurePolicy::DropOldest;
+    consolePolicy.queueDepth = 4;
+
+    // Fan ticks out to the publishers; each runs on its own thread behind a
+    // queue, and JSON is serialized once for all sinks that read it
+    PublishDispatcher dispatcher;
+    if (useFile) {
+        dispatcher.addSink("file", *filePublisher, sinkPolicy);
+    }
+    if (binaryPublisher) {
+        dispatcher.addSink("binary", *binaryPublisher, sinkPolicy);
+    }
+    if (mappedFilePublisher && mappedFilePublisher->isOpen()) {
+        dispatcher.addSink("mmap", *mappedFilePublisher, sinkPolicy);
+    }
     if (useKafka) {
-        sim.registerVehicleUpdateCallback([&kafkaPublisher](const Vehicle& vehicle) {
-            kafkaPublisher->publishVehicleUpdate(vehicle);
+        dispatcher.addSink("kafka", *kafkaPublisher, sinkPolicy);
+    }
+    if (useConsole) {
+        consolePublisher.setDispatcher(&dispatcher);
+        dispatcher.addSink("console", consolePublisher, consolePolicy);
+    }
+    // With --dead-reckoning only updates a consumer could not predict are published
+    DeadReckoningFilter publishFilter(deadReckoningConfig);
+    if (deadReckoning) {
+        // A dropped tick took reports with it; the console is only read by people, so its drops do not count
+        dispatcher.setDropCallback([&publishFilter](const std::string& sink, const TickInfo& info,
+                                                    const std::vector<VehicleRecord>& records) {
+            if (sink == "console") {
+                return;
+            }
+            for (const VehicleRecord& record : records) {
+                publishFilter.invalidate(record.state.handle, info.simulationTime);
+            }
+        });
+    }
+    if (dispatcher.getSinkCount() > 0) {
+        sim.registerTickCallback([&dispatcher, &publishFilter, deadReckoning](const TickSnapshot& snapshot) {
+            dispatcher.publishTick(deadReckoning ? publishFilter.filter(snapshot) : snapshot);
         });
     }
-#endif
 
     // Start simulation
     sim.start();
 
-    // Run for a while, printing updates
+    // Run for a while
     std::cout << "Starting simulation..." << std::endl;
 
     // Run for 20 seconds of simulation time
     double simulationDuration = 20.0;
 
-    while (sim.getSimulationTime() < simulationDuration) {
-        // Update simulation by one time step
-        sim.update();
+    // Pace ticks at the requested real-time factor (--fast runs them back to back)
+    SimulationClock clock(sim.getTimeStep(), realTimeFactor);
+    sim.runFor(simulationDuration, clock);
+
+    // Let pipelined publishing and the sink queues catch up before reporting
+    sim.waitForPublishing();
+    dispatcher.flush();
+    for (const SinkStats& stats : dispatcher.getStats()) {
+        std::cout << "Sink " << stats.name << ": " << stats.ticksPublished << " of "
+                  << stats.ticksOffered << " ticks published ("
+                  << stats.recordsPublished << " records), " << stats.ticksDropped << " dropped, "
+                  << stats.blockedSeconds << " s blocked, high-water mark " << stats.highWaterMark
+                  << " of " << (stats.name == "console" ? consolePolicy : sinkPolicy).queueDepth << std::endl;
+    }
+    if (useFile && filePublisher->getBackend() == FileBackend::IoUring) {
+        UringWriterStats stats = filePublisher->getUringStats();
+        std::cout << "io_uring writer: " << stats.writesCompleted << " of " << stats.writesSubmitted
+                  << " writes completed (" << stats.bytesWritten << " bytes), " << stats.writeErrors
+                  << " errors, max " << stats.maxInFlight << " in flight, " << stats.bufferWaits
+                  << " buffer waits, latency avg " << stats.averageLatencySeconds << " s max "
+                  << stats.maxLatencySeconds << " s" << (stats.registeredBuffers ? ", registered buffers" : "")
+                  << (stats.directIo ? ", direct I/O" : "") << std::endl;
+    }
+    if (deadReckoning) {
+        const DeadReckoningStats& stats = publishFilter.getStats();
+        std::cout << "Dead reckoning: " << stats.published << " of " << stats.considered
+                  << " updates published (" << stats.heartbeats << " heartbeats, " << stats.invalidated
+                  << " resent after sink drops), " << stats.suppressionRatio() * 100.0 << "% suppressed" << std::endl;
+    }
+    if (useKafka) {
+        KafkaPublisherStats stats = kafkaPublisher->getStats();
+        std::cout << "Kafka publisher: " << stats.delivered << " of " << stats.produced
+                  << " messages delivered, " << stats.failed << " failed, " << stats.dropped
+                  << " dropped after " << stats.queueFullRetries << " queue-full retries, latency avg "
+                  << stats.averageLatencySeconds << " s max " << stats.maxLatencySeconds << " s, "
+                  << stats.pooledBuffers << " pooled buffers, " << stats.records << " updates in "
+                  << stats.payloadBytes << " payload bytes";
+        if (kafkaConfig.encoding == KafkaEncoding::Delta) {
+            std::cout << " (" << stats.keyframes << " keyframes)";
+        }
+        std::cout << std::endl;
+    }
+    if (mockKafka != nullptr) {
+        MockKafkaStats stats = mockKafka->getStats();
+        std::cout << "Mock Kafka broker: " << stats.delivered << " delivered (" << stats.bytesDelivered
+                  << " bytes), " << stats.failed << " failed, " << stats.rejected << " queue-full rejections, "
+                  << stats.maxQueued << " max queued, " << mockKafka->getCorruptPayloads()
+                  << " corrupt payloads" << std::endl;
+    }
+    ClockStats clockStats = clock.getStats();
+    std::cout << "Clock: " << clockStats.ticks << " ticks in " << clockStats.wallSeconds << " s ("
+              << clockStats.achievedRealTimeFactor() << "x real time), "
+              << clockStats.overruns << " overruns (max " << clockStats.maxOverrunSeconds << " s), "
+              << clockStats.resyncs << " resyncs, max tick " << clockStats.maxTickSeconds << " s" << std::endl;
+    if (pipelined) {
+        PipelineStats stats = sim.getPipelineStats();
+        std::cout << "Publishing pipeline: " << stats.ticksDelivered << " of " << stats.ticksPublished
+                  << " ticks delivered, " << stats.ticksDropped << " dropped, "
+                  << stats.ticksCoalesced << " coalesced, "
+                  << stats.blockedSeconds << " s blocked" << std::endl;
+    }
 
-        // Sleep to avoid maxing out CPU
-        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    if (validateKernel) {
+        const KernelDiff& report = sim.getKernelValidationReport();
+        std::cout << "Kernel validation over " << report.vehiclesCompared << " vehicle steps: "
+                  << "max position error " << report.maxPositionError
+                  << ", max heading error " << report.maxHeadingError
+                  << ", max speed error " << report.maxSpeedError
+                  << ", waypoint mismatches " << report.waypointMismatches << std::endl;
     }
 
     std::cout << "Simulation completed." << std::endl;